@@ -0,0 +1,1039 @@
+// Generates gpad_gamecontrollerdb.inl and gpad_gamecontrollerdb_<platform>.bin from gamecontrollerdb.txt.
+// Run from the gpad directory, build_linux.sh and build_windows.cmd do that before building the library.
+//
+//     build_db [options]
+//
+// Options:
+//     --check             Write nothing, fail if gpad_gamecontrollerdb.inl is out of date.
+//     --platform NAME     Only emit linux, windows or mac. Can be repeated, all platforms by default.
+//     --strip-names       Leave out controller names, they are only used for debugging.
+//     --allow VID:PID     Only keep controllers with this USB vendor and product ID, in hex. Can be repeated.
+//     --allow-file PATH   Same as --allow with one VID:PID per line, '#' starts a comment.
+//     --max-size BYTES    Fail if the tables of any emitted platform are larger than this.
+//     --compress          Embed the mapping pool compressed, mappings are decoded when a device first uses them.
+//                         Only affects the .inl, the .bin files are mapped from disk on demand anyway.
+//     --output PATH       Write the .inl to PATH instead of gpad_gamecontrollerdb.inl, and no .bin files. Build
+//                         gpad_mapping.c with GPAD_DATABASE_INL set to it, the tests use this for --compress.
+//
+// A size report of the tables compiled into the library is printed for every emitted platform.
+//
+// The binary files are written from the same structs the library reads, so this assumes a little endian host.
+
+#include "../gpad.h"
+#include "../gpad_mapping.h"
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum Platform {
+    Platform_Linux,
+    Platform_Windows,
+    Platform_Mac,
+    Platform_COUNT,
+} Platform;
+
+// Android and iOS mappings are skipped.
+static const char* const g_platform_names[Platform_COUNT] = {"Linux", "Windows", "Mac OS X"};
+static const char* const g_platform_macros[Platform_COUNT] = {"LINUX", "WINDOWS", "MAC"};
+static const char* const g_platform_files[Platform_COUNT] = {"linux", "windows", "mac"};
+
+typedef struct Sdl_Field {
+    const char* name;
+    bool axis;
+    uint8_t index; // Gpad_Button or Gpad_Axis
+} Sdl_Field;
+
+static const Sdl_Field g_sdl_fields[] = {
+    {"a", false, Gpad_Button_A},
+    {"b", false, Gpad_Button_B},
+    {"x", false, Gpad_Button_X},
+    {"y", false, Gpad_Button_Y},
+    {"leftshoulder", false, Gpad_Button_Left_Shoulder},
+    {"rightshoulder", false, Gpad_Button_Right_Shoulder},
+    {"back", false, Gpad_Button_Back},
+    {"start", false, Gpad_Button_Start},
+    {"guide", false, Gpad_Button_Guide},
+    {"leftstick", false, Gpad_Button_Left_Thumb},
+    {"rightstick", false, Gpad_Button_Right_Thumb},
+    {"dpup", false, Gpad_Button_Dpad_Up},
+    {"dpright", false, Gpad_Button_Dpad_Right},
+    {"dpdown", false, Gpad_Button_Dpad_Down},
+    {"dpleft", false, Gpad_Button_Dpad_Left},
+    {"leftx", true, Gpad_Axis_Left_X},
+    {"lefty", true, Gpad_Axis_Left_Y},
+    {"rightx", true, Gpad_Axis_Right_X},
+    {"righty", true, Gpad_Axis_Right_Y},
+    {"lefttrigger", true, Gpad_Axis_Left_Trigger},
+    {"righttrigger", true, Gpad_Axis_Right_Trigger},
+};
+
+typedef struct Row {
+    Gpad_Guid guid;
+    // Pseudo GUIDs like "xinput" are stored as their characters and left out of the hash index.
+    bool pseudo_guid;
+    const char* name; // Points into the input text
+    size_t name_len;
+    Gpad_Mapping mapping;
+    uint16_t pool_index;
+    uint16_t name_offset;
+} Row;
+
+typedef struct Buffer {
+    char* data;
+    size_t size;
+    size_t capacity;
+} Buffer;
+
+typedef struct Perfect_Hash {
+    uint16_t* displacements;
+    uint32_t num_buckets;
+    uint16_t* slots; // Row index, 0xffff for empty slots
+    uint32_t num_slots;
+} Perfect_Hash;
+
+// Mappings per compressed block. Bigger blocks compress better but cost more to decode.
+#define GPAD__COMPRESSED_POOL_BLOCK_SIZE 16
+
+typedef struct Table {
+    Row* rows;
+    int num_rows;
+    Gpad_Mapping* pool;
+    int num_pool;
+    char* names;
+    int names_size;
+    Perfect_Hash index; // Over the GUIDs
+    Perfect_Hash key_index; // Over gpad__guid_key, for the fallback lookup
+    // --compress only, the pool in blocks of GPAD__COMPRESSED_POOL_BLOCK_SIZE mappings.
+    Buffer compressed_pool;
+    uint32_t* block_offsets; // Into compressed_pool, one more than the number of blocks
+    int num_blocks;
+} Table;
+
+static Table g_tables[Platform_COUNT];
+
+static struct {
+    bool check;
+    bool platforms[Platform_COUNT];
+    bool strip_names;
+    bool compress;
+    const char* output;
+    uint32_t* allowed; // (vendor << 16) | product
+    int num_allowed;
+    long max_size;
+} g_options;
+
+static void fail(const char* format, ...) {
+    fflush(stdout);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+static void* checked_realloc(void* data, const size_t size) {
+    void* result = realloc(data, size);
+    if(!result) fail("Out of memory");
+    return result;
+}
+
+static void buffer_append(Buffer* b, const void* data, const size_t size) {
+    if(b->size + size > b->capacity) {
+        b->capacity = b->capacity * 2 + size;
+        b->data = (char*)checked_realloc(b->data, b->capacity);
+    }
+    memcpy(b->data + b->size, data, size);
+    b->size += size;
+}
+
+static void buffer_printf(Buffer* b, const char* format, ...) {
+    char temp[1024];
+    va_list args;
+    va_start(args, format);
+    const int len = vsnprintf(temp, sizeof(temp), format, args);
+    va_end(args);
+    if(len < 0 || len >= (int)sizeof(temp)) fail("Formatted string too long");
+    buffer_append(b, temp, (size_t)len);
+}
+
+static void buffer_align(Buffer* b, const size_t alignment) {
+    static const uint8_t zeros[8] = {0};
+    if(b->size % alignment != 0) {
+        buffer_append(b, zeros, alignment - b->size % alignment);
+    }
+}
+
+static char* read_entire_file(const char* path, size_t* out_size) {
+    FILE* file = fopen(path, "rb");
+    if(!file) return NULL;
+    Buffer b = {0};
+    char temp[16 * 1024];
+    size_t read;
+    while((read = fread(temp, 1, sizeof(temp), file)) > 0) {
+        buffer_append(&b, temp, read);
+    }
+    fclose(file);
+    buffer_append(&b, "", 1);
+    *out_size = b.size - 1;
+    return b.data;
+}
+
+static bool write_entire_file(const char* path, const void* data, const size_t size) {
+    FILE* file = fopen(path, "wb");
+    if(!file) return false;
+    const bool ok = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && ok;
+}
+
+//
+// Parsing, same semantics as the runtime loader in gpad_mapping.c
+//
+
+static bool str_equal(const char* str, const char* end, const char* other) {
+    const size_t len = strlen(other);
+    return (size_t)(end - str) == len && memcmp(str, other, len) == 0;
+}
+
+static int hex_digit(const char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Returns the end of the number or NULL if there are no digits.
+static const char* parse_uint(const char* str, const char* end, int* out_value) {
+    if(str >= end || *str < '0' || *str > '9') return NULL;
+    int value = 0;
+    for(; str < end && *str >= '0' && *str <= '9' && value < 256; str++) {
+        value = value * 10 + (*str - '0');
+    }
+    *out_value = value;
+    return str;
+}
+
+// Element like "b0", "a2", "+a3", "-a1", "a2~" or "h0.4".
+// Axis inputs get a scale and offset which map their input range to -1..1, inverted with "~".
+static bool parse_elem(Gpad_Mapping_Elem* out_elem, const char* str, const char* end) {
+    Gpad_Mapping_Elem elem = {0};
+    int minimum = -1;
+    int maximum = 1;
+
+    if(str < end && *str == '+') {
+        minimum = 0;
+        str++;
+    } else if(str < end && *str == '-') {
+        maximum = 0;
+        str++;
+    }
+
+    const bool invert = end > str && end[-1] == '~';
+    if(invert) end--;
+
+    if(str >= end) return false;
+    switch(*str++) {
+        case 'a': elem.kind = Gpad_Mapping_Kind_Axis; break;
+        case 'b': elem.kind = Gpad_Mapping_Kind_Button; break;
+        case 'h': elem.kind = Gpad_Mapping_Kind_Hatbit; break;
+        default: return false;
+    }
+
+    int index = 0;
+    str = parse_uint(str, end, &index);
+    if(!str) return false;
+
+    if(elem.kind == Gpad_Mapping_Kind_Hatbit) {
+        int bit = 0;
+        if(str >= end || *str != '.') return false;
+        str = parse_uint(str + 1, end, &bit);
+        if(!str) return false;
+        index = (index << 4) | bit;
+    }
+
+    if(str != end || index > 0xff) return false;
+    elem.index = (uint8_t)index;
+
+    if(elem.kind == Gpad_Mapping_Kind_Axis) {
+        elem.axis_scale = (int8_t)(2 / (maximum - minimum));
+        elem.axis_offset = (int8_t)-(maximum + minimum);
+        if(invert) {
+            elem.axis_scale *= -1;
+            elem.axis_offset *= -1;
+        }
+    }
+
+    *out_elem = elem;
+    return true;
+}
+
+static void parse_field(Gpad_Mapping* mapping, const char* ident, const char* ident_end, const char* value, const char* value_end) {
+    // Output modifier, the input only drives one half of the axis.
+    const char modifier = *ident;
+    const bool half = modifier == '+' || modifier == '-';
+    if(half) ident++;
+
+    for(int i = 0; i < (int)(sizeof(g_sdl_fields) / sizeof(g_sdl_fields[0])); i++) {
+        const Sdl_Field* sdl_field = &g_sdl_fields[i];
+        if(!str_equal(ident, ident_end, sdl_field->name)) continue;
+
+        if(!sdl_field->axis) {
+            if(!half) {
+                parse_elem(&mapping->buttons[sdl_field->index], value, value_end);
+            }
+        } else if(!half) {
+            parse_elem(&mapping->axes[sdl_field->index], value, value_end);
+        } else {
+            Gpad_Mapping_Elem* elem = modifier == '+' ? &mapping->axes[sdl_field->index]
+                                                      : &mapping->negative_axes[sdl_field->index];
+            if(parse_elem(elem, value, value_end)) {
+                mapping->half_axes |= 1 << sdl_field->index;
+            }
+        }
+        return;
+    }
+}
+
+// Returns false for comments and lines for skipped platforms.
+static bool parse_line(const char* line, const char* end, const int line_number, Row* out_row, Platform* out_platform) {
+    while(end > line && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) end--;
+    while(line < end && (*line == ' ' || *line == '\t')) line++;
+    if(line >= end || *line == '#') return false;
+
+    Row row = {0};
+
+    const char* guid_end = (const char*)memchr(line, ',', end - line);
+    if(!guid_end) fail("Line %i: missing GUID", line_number);
+
+    bool hex = guid_end - line == 32;
+    for(int i = 0; hex && i < 16; i++) {
+        const int hi = hex_digit(line[i * 2]);
+        const int lo = hex_digit(line[i * 2 + 1]);
+        hex = hi >= 0 && lo >= 0;
+        row.guid.data[i] = (uint8_t)((hi << 4) | lo);
+    }
+    if(!hex) {
+        if(guid_end - line > 16) fail("Line %i: invalid GUID", line_number);
+        memset(&row.guid, 0, sizeof(row.guid));
+        memcpy(row.guid.data, line, guid_end - line);
+        row.pseudo_guid = true;
+    }
+
+    row.name = guid_end + 1;
+    const char* name_end = (const char*)memchr(row.name, ',', end - row.name);
+    if(!name_end) fail("Line %i: missing name", line_number);
+    row.name_len = name_end - row.name;
+
+    int platform = -1;
+    for(const char* field = name_end + 1; field < end;) {
+        const char* field_end = (const char*)memchr(field, ',', end - field);
+        if(!field_end) field_end = end;
+
+        const char* colon = (const char*)memchr(field, ':', field_end - field);
+        if(colon) {
+            if(str_equal(field, colon, "platform")) {
+                for(int i = 0; i < Platform_COUNT; i++) {
+                    if(str_equal(colon + 1, field_end, g_platform_names[i])) platform = i;
+                }
+                if(platform < 0) return false;
+            } else {
+                parse_field(&row.mapping, field, colon, colon + 1, field_end);
+            }
+        }
+
+        field = field_end + 1;
+    }
+
+    if(platform < 0) fail("Line %i: missing platform", line_number);
+
+    *out_row = row;
+    *out_platform = (Platform)platform;
+    return true;
+}
+
+// GUIDs in the standard form (bus, crc, vendor, 0, product, 0, version, driver) carry the USB IDs, same test as SDL.
+// Pseudo GUIDs and GUIDs made from the device name don't.
+static bool guid_vendor_product(const Row* row, uint16_t* out_vendor, uint16_t* out_product) {
+    Gpad_Guid key;
+    if(row->pseudo_guid || !gpad__guid_key(&row->guid, &key)) return false;
+    *out_vendor = (uint16_t)(key.data[4] | (key.data[5] << 8));
+    *out_product = (uint16_t)(key.data[8] | (key.data[9] << 8));
+    return true;
+}
+
+static bool row_allowed(const Row* row) {
+    if(g_options.num_allowed == 0) return true;
+    uint16_t vendor = 0;
+    uint16_t product = 0;
+    if(!guid_vendor_product(row, &vendor, &product)) return false;
+    for(int i = 0; i < g_options.num_allowed; i++) {
+        if(g_options.allowed[i] == (((uint32_t)vendor << 16) | product)) return true;
+    }
+    return false;
+}
+
+// "045e:028e"
+static bool parse_allowed(const char* str, const char* end) {
+    int value = 0;
+    int digits = 0;
+    for(; str < end; str++) {
+        if(*str == ':' && digits == 4) continue;
+        const int digit = hex_digit(*str);
+        if(digit < 0 || digits == 8) return false;
+        value = (value << 4) | digit;
+        digits++;
+    }
+    if(digits != 8) return false;
+    g_options.allowed = (uint32_t*)checked_realloc(g_options.allowed, (g_options.num_allowed + 1) * sizeof(uint32_t));
+    g_options.allowed[g_options.num_allowed++] = (uint32_t)value;
+    return true;
+}
+
+static void parse_allow_file(const char* path) {
+    size_t size = 0;
+    char* text = read_entire_file(path, &size);
+    if(!text) fail("Couldn't read %s", path);
+
+    int line_number = 1;
+    for(const char* line = text; line < text + size; line_number++) {
+        const char* line_end = (const char*)memchr(line, '\n', text + size - line);
+        if(!line_end) line_end = text + size;
+
+        const char* end = (const char*)memchr(line, '#', line_end - line);
+        if(!end) end = line_end;
+        while(end > line && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) end--;
+        while(line < end && (*line == ' ' || *line == '\t')) line++;
+        if(line < end && !parse_allowed(line, end)) fail("%s:%i: expected VID:PID", path, line_number);
+
+        line = line_end + 1;
+    }
+    free(text);
+}
+
+// Later lines replace earlier ones with the same GUID, like in SDL.
+static void add_row(Table* table, const Row* row) {
+    for(int i = 0; i < table->num_rows; i++) {
+        if(gpad__guid_equal(&table->rows[i].guid, &row->guid)) {
+            table->rows[i] = *row;
+            return;
+        }
+    }
+    table->rows = (Row*)checked_realloc(table->rows, (table->num_rows + 1) * sizeof(Row));
+    table->rows[table->num_rows++] = *row;
+}
+
+//
+// Tables
+//
+
+// Many rows share the same elements or name, both are interned so each row only stores indices.
+static void build_pool(Table* table) {
+    for(int i = 0; i < table->num_rows; i++) {
+        Row* row = &table->rows[i];
+
+        int pool_index = 0;
+        while(pool_index < table->num_pool && memcmp(&table->pool[pool_index], &row->mapping, sizeof(Gpad_Mapping)) != 0) {
+            pool_index++;
+        }
+        if(pool_index == table->num_pool) {
+            table->pool = (Gpad_Mapping*)checked_realloc(table->pool, (table->num_pool + 1) * sizeof(Gpad_Mapping));
+            table->pool[table->num_pool++] = row->mapping;
+        }
+
+        int name_row = 0;
+        while(name_row < i && (table->rows[name_row].name_len != row->name_len ||
+                                  memcmp(table->rows[name_row].name, row->name, row->name_len) != 0)) {
+            name_row++;
+        }
+        if(name_row == i) {
+            row->name_offset = (uint16_t)table->names_size;
+            table->names = (char*)checked_realloc(table->names, table->names_size + row->name_len + 1);
+            memcpy(table->names + table->names_size, row->name, row->name_len);
+            table->names[table->names_size + row->name_len] = 0;
+            table->names_size += (int)row->name_len + 1;
+        } else {
+            row->name_offset = table->rows[name_row].name_offset;
+        }
+
+        if(table->num_pool > 0xffff || table->names_size > 0xffff) fail("Database too large");
+        row->pool_index = (uint16_t)pool_index;
+    }
+}
+
+// Hash-and-displace perfect hash. Each key goes into a bucket by its unseeded hash,
+// every bucket gets a seed which sends all of its keys to distinct free slots.
+static Perfect_Hash build_perfect_hash(const Gpad_Guid* keys, const uint16_t* values, const int count) {
+    Perfect_Hash hash;
+    hash.num_slots = 4;
+    while(hash.num_slots < (uint32_t)(count + count / 4)) hash.num_slots *= 2;
+    hash.num_buckets = hash.num_slots / 4;
+
+    hash.displacements = (uint16_t*)calloc(hash.num_buckets, sizeof(uint16_t));
+    hash.slots = (uint16_t*)malloc(hash.num_slots * sizeof(uint16_t));
+    uint32_t* buckets = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+    uint32_t* bucket_sizes = (uint32_t*)calloc(hash.num_buckets, sizeof(uint32_t));
+    int* members = (int*)malloc((count + 1) * sizeof(int));
+    uint32_t* taken = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+    if(!hash.displacements || !hash.slots || !buckets || !bucket_sizes || !members || !taken) fail("Out of memory");
+
+    memset(hash.slots, 0xff, hash.num_slots * sizeof(uint16_t));
+
+    uint32_t max_bucket = 0;
+    for(int i = 0; i < count; i++) {
+        buckets[i] = gpad__guid_hash(&keys[i], 0) & (hash.num_buckets - 1);
+        if(++bucket_sizes[buckets[i]] > max_bucket) max_bucket = bucket_sizes[buckets[i]];
+    }
+
+    // Largest buckets first, while there are still plenty of free slots.
+    for(uint32_t size = max_bucket; size > 0; size--) {
+        for(uint32_t bucket = 0; bucket < hash.num_buckets; bucket++) {
+            if(bucket_sizes[bucket] != size) continue;
+
+            int num_members = 0;
+            for(int i = 0; i < count; i++) {
+                if(buckets[i] == bucket) members[num_members++] = i;
+            }
+
+            uint32_t seed = 1;
+            for(; seed < 0x10000; seed++) {
+                int num_taken = 0;
+                for(; num_taken < num_members; num_taken++) {
+                    const uint32_t slot = gpad__guid_hash(&keys[members[num_taken]], seed) & (hash.num_slots - 1);
+                    bool free = hash.slots[slot] == 0xffff;
+                    for(int j = 0; free && j < num_taken; j++) {
+                        free = taken[j] != slot;
+                    }
+                    if(!free) break;
+                    taken[num_taken] = slot;
+                }
+                if(num_taken == num_members) break;
+            }
+            if(seed == 0x10000) fail("Couldn't build the perfect hash");
+
+            for(int i = 0; i < num_members; i++) {
+                hash.slots[taken[i]] = values[members[i]];
+            }
+            hash.displacements[bucket] = (uint16_t)seed;
+        }
+    }
+
+    free(buckets);
+    free(bucket_sizes);
+    free(members);
+    free(taken);
+    return hash;
+}
+
+// Pseudo GUIDs can't be looked up. Rows of the same bus, vendor and product share one key index entry, the one with
+// the most common mapping among them: cheap clones reuse the IDs of popular pads, but mostly keep their layout.
+static void build_indices(Table* table) {
+    Gpad_Guid* keys = (Gpad_Guid*)malloc((table->num_rows + 1) * sizeof(Gpad_Guid));
+    uint16_t* values = (uint16_t*)malloc((table->num_rows + 1) * sizeof(uint16_t));
+    int* votes = (int*)malloc((table->num_rows + 1) * sizeof(int));
+    if(!keys || !values || !votes) fail("Out of memory");
+
+    int count = 0;
+    for(int i = 0; i < table->num_rows; i++) {
+        if(table->rows[i].pseudo_guid) continue;
+        keys[count] = table->rows[i].guid;
+        values[count++] = (uint16_t)i;
+    }
+    table->index = build_perfect_hash(keys, values, count);
+
+    count = 0;
+    for(int i = 0; i < table->num_rows; i++) {
+        Gpad_Guid key;
+        if(table->rows[i].pseudo_guid || !gpad__guid_key(&table->rows[i].guid, &key)) continue;
+
+        int j = 0;
+        while(j < count && !gpad__guid_equal(&keys[j], &key)) j++;
+        if(j == count) {
+            keys[count] = key;
+            values[count] = 0xffff;
+            votes[count++] = 0;
+        }
+
+        // Rows with this key and the same mapping, the first of them represents the key on ties.
+        int same = 0;
+        for(int k = 0; k <= i; k++) {
+            Gpad_Guid other;
+            if(!table->rows[k].pseudo_guid && gpad__guid_key(&table->rows[k].guid, &other) &&
+               gpad__guid_equal(&other, &key) && table->rows[k].pool_index == table->rows[i].pool_index) {
+                same++;
+            }
+        }
+        if(same > votes[j]) {
+            votes[j] = same;
+            if(values[j] == 0xffff || table->rows[values[j]].pool_index != table->rows[i].pool_index) {
+                values[j] = (uint16_t)i;
+            }
+        }
+    }
+    table->key_index = build_perfect_hash(keys, values, count);
+
+    free(keys);
+    free(values);
+    free(votes);
+}
+
+//
+// Compression
+//
+// LZ77 with byte aligned sequences, decoded by gpad__lz_decode in gpad_mapping.c:
+//     token: literal count << 4 | (match length - 4), a nibble of 15 continues in following bytes until one isn't 255
+//     literals
+//     match offset, 16 bit little endian. Left out after the last literals of a block.
+//
+
+static void lz_write_length(Buffer* out, size_t length) {
+    for(; length >= 255; length -= 255) {
+        buffer_append(out, "\xff", 1);
+    }
+    const uint8_t byte = (uint8_t)length;
+    buffer_append(out, &byte, 1);
+}
+
+static void lz_write_sequence(Buffer* out, const uint8_t* literals, const size_t num_literals, const size_t offset, const size_t match_length) {
+    const size_t match_nibble = match_length ? match_length - 4 : 0;
+    const uint8_t token = (uint8_t)((num_literals < 15 ? num_literals : 15) << 4 | (match_nibble < 15 ? match_nibble : 15));
+    buffer_append(out, &token, 1);
+    if(num_literals >= 15) lz_write_length(out, num_literals - 15);
+    buffer_append(out, literals, num_literals);
+    if(match_length == 0) return;
+
+    const uint8_t offset_bytes[2] = {(uint8_t)offset, (uint8_t)(offset >> 8)};
+    buffer_append(out, offset_bytes, 2);
+    if(match_nibble >= 15) lz_write_length(out, match_nibble - 15);
+}
+
+// Blocks are small, so this simply takes the longest match at every position.
+static void lz_compress(Buffer* out, const uint8_t* data, const size_t size) {
+    size_t literal_start = 0;
+    size_t pos = 0;
+    while(pos < size) {
+        size_t best_length = 0;
+        size_t best_offset = 0;
+        for(size_t candidate = pos > 0xffff ? pos - 0xffff : 0; candidate < pos; candidate++) {
+            size_t length = 0;
+            while(pos + length < size && data[candidate + length] == data[pos + length]) length++;
+            if(length >= best_length) {
+                best_length = length;
+                best_offset = pos - candidate;
+            }
+        }
+
+        if(best_length < 4) {
+            pos++;
+            continue;
+        }
+
+        lz_write_sequence(out, data + literal_start, pos - literal_start, best_offset, best_length);
+        pos += best_length;
+        literal_start = pos;
+    }
+    // A block always ends with literals, possibly none.
+    lz_write_sequence(out, data + literal_start, size - literal_start, 0, 0);
+}
+
+static void compress_pool(Table* table) {
+    table->num_blocks = (table->num_pool + GPAD__COMPRESSED_POOL_BLOCK_SIZE - 1) / GPAD__COMPRESSED_POOL_BLOCK_SIZE;
+    table->block_offsets = (uint32_t*)checked_realloc(NULL, (table->num_blocks + 1) * sizeof(uint32_t));
+    for(int block = 0; block < table->num_blocks; block++) {
+        const int first = block * GPAD__COMPRESSED_POOL_BLOCK_SIZE;
+        int count = table->num_pool - first;
+        if(count > GPAD__COMPRESSED_POOL_BLOCK_SIZE) count = GPAD__COMPRESSED_POOL_BLOCK_SIZE;
+
+        table->block_offsets[block] = (uint32_t)table->compressed_pool.size;
+        lz_compress(&table->compressed_pool, (const uint8_t*)&table->pool[first], count * sizeof(Gpad_Mapping));
+    }
+    table->block_offsets[table->num_blocks] = (uint32_t)table->compressed_pool.size;
+}
+
+static size_t pool_size(const Table* table) {
+    if(g_options.compress) {
+        return table->compressed_pool.size + (table->num_blocks + 1) * sizeof(uint32_t);
+    }
+    return table->num_pool * sizeof(Gpad_Mapping);
+}
+
+static size_t hash_size(const Perfect_Hash* hash) {
+    return (hash->num_buckets + hash->num_slots) * sizeof(uint16_t);
+}
+
+// Bytes of the tables compiled into the library, same as the sections of the binary database.
+static size_t table_size(const Table* table) {
+    return table->num_rows * (sizeof(Gpad_Guid) + sizeof(Gpad_Mapping_Row)) + pool_size(table) + table->names_size +
+           hash_size(&table->index) + hash_size(&table->key_index);
+}
+
+static void print_size_report(const Table* table, const Platform platform) {
+    printf("%s: %i mappings, %i unique\n", g_platform_names[platform], table->num_rows, table->num_pool);
+    printf("    guids %i, rows %i, pool %i, names %i, hash index %i, key index %i, total %i bytes\n",
+        (int)(table->num_rows * sizeof(Gpad_Guid)),
+        (int)(table->num_rows * sizeof(Gpad_Mapping_Row)),
+        (int)pool_size(table),
+        table->names_size,
+        (int)hash_size(&table->index),
+        (int)hash_size(&table->key_index),
+        (int)table_size(table));
+}
+
+//
+// Output
+//
+
+static void write_platform_begin(Buffer* b, const Platform platform) {
+    buffer_printf(b, "#ifdef GPAD_PLATFORM_%s\n", g_platform_macros[platform]);
+}
+
+static void write_platform_end(Buffer* b, const Platform platform) {
+    buffer_printf(b, "#endif // GPAD_PLATFORM_%s\n\n\n", g_platform_macros[platform]);
+}
+
+static void write_elems(Buffer* b, const Gpad_Mapping_Elem* elems, const int count) {
+    for(int i = 0; i < count; i++) {
+        buffer_printf(b, "{%i, %i, %i, %i},\n", elems[i].kind, elems[i].index, elems[i].axis_scale, elems[i].axis_offset);
+    }
+}
+
+// Names are used as they are, including stray whitespace.
+static void write_string_literal(Buffer* b, const char* str) {
+    buffer_printf(b, "\"");
+    for(; *str; str++) {
+        if(*str == '"' || *str == '\\') {
+            buffer_printf(b, "\\%c", *str);
+        } else if(*str == '\t') {
+            buffer_printf(b, "\\t");
+        } else if((unsigned char)*str < ' ') {
+            buffer_printf(b, "\\%03o", (unsigned char)*str);
+        } else {
+            buffer_append(b, str, 1);
+        }
+    }
+    buffer_printf(b, "\\0\"\n");
+}
+
+static void write_u16_array(Buffer* b, const uint16_t* values, const uint32_t count) {
+    for(uint32_t i = 0; i < count; i++) {
+        buffer_printf(b, "%u,%s", values[i], i % 16 == 15 || i == count - 1 ? "\n" : " ");
+    }
+}
+
+// Sizes are powers of two.
+static void write_perfect_hash(Buffer* b, const char* name, const size_t offset) {
+    buffer_printf(b, "static const uint16_t %s_displacements[] = {\n", name);
+    for(int p = 0; p < Platform_COUNT; p++) {
+        if(!g_options.platforms[p]) continue;
+        const Perfect_Hash* hash = (const Perfect_Hash*)((const char*)&g_tables[p] + offset);
+        write_platform_begin(b, (Platform)p);
+        write_u16_array(b, hash->displacements, hash->num_buckets);
+        write_platform_end(b, (Platform)p);
+    }
+    buffer_printf(b, "};\n\n\n\n\n");
+
+    buffer_printf(b, "static const uint16_t %s_slots[] = {\n", name);
+    for(int p = 0; p < Platform_COUNT; p++) {
+        if(!g_options.platforms[p]) continue;
+        const Perfect_Hash* hash = (const Perfect_Hash*)((const char*)&g_tables[p] + offset);
+        write_platform_begin(b, (Platform)p);
+        write_u16_array(b, hash->slots, hash->num_slots);
+        write_platform_end(b, (Platform)p);
+    }
+    buffer_printf(b, "};");
+}
+
+static void write_pool(Buffer* b) {
+    buffer_printf(b, "static const Gpad_Mapping g_gpad_mapping_pool[] = {\n");
+
+    for(int p = 0; p < Platform_COUNT; p++) {
+        if(!g_options.platforms[p]) continue;
+        const Table* table = &g_tables[p];
+        write_platform_begin(b, (Platform)p);
+        for(int i = 0; i < table->num_pool; i++) {
+            const Gpad_Mapping* mapping = &table->pool[i];
+            buffer_printf(b, "{\n{\n");
+            write_elems(b, mapping->buttons, Gpad_Button_COUNT);
+            buffer_printf(b, "},{\n");
+            write_elems(b, mapping->axes, Gpad_Axis_COUNT);
+            buffer_printf(b, "},{\n");
+            write_elems(b, mapping->negative_axes, Gpad_Axis_COUNT);
+            buffer_printf(b, "},%u,},\n", mapping->half_axes);
+        }
+        write_platform_end(b, (Platform)p);
+    }
+    buffer_printf(b, "};\n\n\n\n\n");
+}
+
+// Replaces g_gpad_mapping_pool, see gpad__get_mapping.
+static void write_compressed_pool(Buffer* b) {
+    buffer_printf(b, "#define GPAD__COMPRESSED_POOL_BLOCK_SIZE %d\n", GPAD__COMPRESSED_POOL_BLOCK_SIZE);
+    for(int p = 0; p < Platform_COUNT; p++) {
+        if(!g_options.platforms[p]) continue;
+        write_platform_begin(b, (Platform)p);
+        buffer_printf(b, "#define GPAD__COMPRESSED_POOL_SIZE %d\n", g_tables[p].num_pool);
+        write_platform_end(b, (Platform)p);
+    }
+    buffer_printf(b, "\n\n\n");
+
+    buffer_printf(b, "static const uint8_t g_gpad_mapping_pool_compressed[] = {\n");
+    for(int p = 0; p < Platform_COUNT; p++) {
+        if(!g_options.platforms[p]) continue;
+        const Buffer* data = &g_tables[p].compressed_pool;
+        write_platform_begin(b, (Platform)p);
+        for(size_t i = 0; i < data->size; i++) {
+            buffer_printf(b, "%u,%s", (uint8_t)data->data[i], i % 32 == 31 || i == data->size - 1 ? "\n" : "");
+        }
+        write_platform_end(b, (Platform)p);
+    }
+    buffer_printf(b, "};\n\n\n\n\n");
+
+    buffer_printf(b, "static const uint32_t g_gpad_mapping_pool_blocks[] = {\n");
+    for(int p = 0; p < Platform_COUNT; p++) {
+        if(!g_options.platforms[p]) continue;
+        const Table* table = &g_tables[p];
+        write_platform_begin(b, (Platform)p);
+        for(int i = 0; i <= table->num_blocks; i++) {
+            buffer_printf(b, "%u,%s", table->block_offsets[i], i % 16 == 15 || i == table->num_blocks ? "\n" : " ");
+        }
+        write_platform_end(b, (Platform)p);
+    }
+    buffer_printf(b, "};\n\n\n\n\n");
+}
+
+// Every platform is in the same file, gpad_mapping.c only sees its own through the GPAD_PLATFORM_* defines.
+static void write_inl(Buffer* b) {
+    buffer_printf(b, "// WARNING: Machine generated! Do not edit!\n");
+
+    // Stripped builds fail loudly instead of compiling empty tables on other platforms.
+    for(int p = 0; p < Platform_COUNT; p++) {
+        if(g_options.platforms[p]) continue;
+        buffer_printf(b, "#ifdef GPAD_PLATFORM_%s\n", g_platform_macros[p]);
+        buffer_printf(b, "#error \"gpad_gamecontrollerdb.inl was generated without %s mappings, rerun build_db\"\n", g_platform_files[p]);
+        buffer_printf(b, "#endif\n");
+    }
+
+    buffer_printf(b, "static const Gpad_Guid g_gpad_mapping_guids[] = {\n");
+    for(int p = 0; p < Platform_COUNT; p++) {
+        if(!g_options.platforms[p]) continue;
+        const Table* table = &g_tables[p];
+        write_platform_begin(b, (Platform)p);
+        for(int i = 0; i < table->num_rows; i++) {
+            const uint8_t* data = table->rows[i].guid.data;
+            buffer_printf(b, "{{");
+            for(int j = 0; j < 16; j++) {
+                buffer_printf(b, "%s0x%02x", j == 0 ? "" : ", ", data[j]);
+            }
+            buffer_printf(b, "}},\n");
+        }
+        write_platform_end(b, (Platform)p);
+    }
+    buffer_printf(b, "};\n\n\n\n\n");
+
+    if(g_options.compress) {
+        write_compressed_pool(b);
+    } else {
+        write_pool(b);
+    }
+
+    // One string literal per name, so a "\0" can't merge with digits of the next name.
+    buffer_printf(b, "static const char g_gpad_mapping_names[] =\n");
+    for(int p = 0; p < Platform_COUNT; p++) {
+        if(!g_options.platforms[p]) continue;
+        const Table* table = &g_tables[p];
+        write_platform_begin(b, (Platform)p);
+        for(int offset = 0; offset < table->names_size; offset += (int)strlen(table->names + offset) + 1) {
+            write_string_literal(b, table->names + offset);
+        }
+        write_platform_end(b, (Platform)p);
+    }
+    buffer_printf(b, "\"\";\n\n\n\n\n");
+
+    buffer_printf(b, "static const Gpad_Mapping_Row g_gpad_mappings[] = {\n");
+    for(int p = 0; p < Platform_COUNT; p++) {
+        if(!g_options.platforms[p]) continue;
+        const Table* table = &g_tables[p];
+        write_platform_begin(b, (Platform)p);
+        for(int i = 0; i < table->num_rows; i++) {
+            buffer_printf(b, "{%u, %u},\n", table->rows[i].pool_index, table->rows[i].name_offset);
+        }
+        write_platform_end(b, (Platform)p);
+    }
+    buffer_printf(b, "};\n\n\n\n\n");
+
+    write_perfect_hash(b, "g_gpad_mapping_hash", offsetof(Table, index));
+    buffer_printf(b, "\n\n\n\n\n");
+    write_perfect_hash(b, "g_gpad_mapping_key", offsetof(Table, key_index));
+}
+
+// Binary database for gpad_load_database_file, see Gpad_Database_Header.
+static void write_database(Buffer* b, const Platform platform) {
+    const Table* table = &g_tables[platform];
+
+    Gpad_Database_Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "GPDB", 4);
+    header.version = GPAD_DATABASE_VERSION;
+    snprintf(header.platform, sizeof(header.platform), "%s", g_platform_names[platform]);
+    header.num_rows = table->num_rows;
+    header.num_pool = table->num_pool;
+    header.num_buckets = table->index.num_buckets;
+    header.num_slots = table->index.num_slots;
+    header.num_key_buckets = table->key_index.num_buckets;
+    header.num_key_slots = table->key_index.num_slots;
+    header.names_size = table->names_size;
+    buffer_append(b, &header, sizeof(header));
+
+    buffer_align(b, 8);
+    header.guids_offset = (uint32_t)b->size;
+    for(int i = 0; i < table->num_rows; i++) {
+        buffer_append(b, &table->rows[i].guid, sizeof(Gpad_Guid));
+    }
+
+    buffer_align(b, 8);
+    header.rows_offset = (uint32_t)b->size;
+    for(int i = 0; i < table->num_rows; i++) {
+        const Gpad_Mapping_Row row = {table->rows[i].pool_index, table->rows[i].name_offset};
+        buffer_append(b, &row, sizeof(row));
+    }
+
+    buffer_align(b, 8);
+    header.pool_offset = (uint32_t)b->size;
+    buffer_append(b, table->pool, table->num_pool * sizeof(Gpad_Mapping));
+
+    buffer_align(b, 8);
+    header.displacements_offset = (uint32_t)b->size;
+    buffer_append(b, table->index.displacements, table->index.num_buckets * sizeof(uint16_t));
+
+    buffer_align(b, 8);
+    header.slots_offset = (uint32_t)b->size;
+    buffer_append(b, table->index.slots, table->index.num_slots * sizeof(uint16_t));
+
+    buffer_align(b, 8);
+    header.names_offset = (uint32_t)b->size;
+    buffer_append(b, table->names, table->names_size);
+
+    buffer_align(b, 8);
+    header.key_displacements_offset = (uint32_t)b->size;
+    buffer_append(b, table->key_index.displacements, table->key_index.num_buckets * sizeof(uint16_t));
+
+    buffer_align(b, 8);
+    header.key_slots_offset = (uint32_t)b->size;
+    buffer_append(b, table->key_index.slots, table->key_index.num_slots * sizeof(uint16_t));
+
+    header.size = (uint32_t)b->size;
+    header.checksum = gpad__database_checksum(
+        (const uint8_t*)b->data + sizeof(Gpad_Database_Header), b->size - sizeof(Gpad_Database_Header));
+    memcpy(b->data, &header, sizeof(header));
+}
+
+static void usage(void) {
+    fail("Usage: build_db [--check] [--platform linux|windows|mac] [--strip-names] [--allow VID:PID] "
+         "[--allow-file PATH] [--max-size BYTES] [--compress] [--output PATH]");
+}
+
+int main(int argc, char** argv) {
+    bool any_platform = false;
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if(strcmp(arg, "--check") == 0) {
+            g_options.check = true;
+        } else if(strcmp(arg, "--strip-names") == 0) {
+            g_options.strip_names = true;
+        } else if(strcmp(arg, "--compress") == 0) {
+            g_options.compress = true;
+        } else if(strcmp(arg, "--output") == 0 && value) {
+            g_options.output = value;
+            i++;
+        } else if(strcmp(arg, "--platform") == 0 && value) {
+            int platform = 0;
+            while(platform < Platform_COUNT && strcmp(value, g_platform_files[platform]) != 0) platform++;
+            if(platform == Platform_COUNT) usage();
+            g_options.platforms[platform] = true;
+            any_platform = true;
+            i++;
+        } else if(strcmp(arg, "--allow") == 0 && value) {
+            if(!parse_allowed(value, value + strlen(value))) usage();
+            i++;
+        } else if(strcmp(arg, "--allow-file") == 0 && value) {
+            parse_allow_file(value);
+            i++;
+        } else if(strcmp(arg, "--max-size") == 0 && value) {
+            g_options.max_size = strtol(value, NULL, 10);
+            if(g_options.max_size <= 0) usage();
+            i++;
+        } else {
+            usage();
+        }
+    }
+    if(!any_platform) {
+        for(int p = 0; p < Platform_COUNT; p++) g_options.platforms[p] = true;
+    }
+
+    size_t size = 0;
+    char* text = read_entire_file("gamecontrollerdb.txt", &size);
+    if(!text) fail("Couldn't find gamecontrollerdb.txt");
+
+    int line_number = 1;
+    for(const char* line = text; line < text + size; line_number++) {
+        const char* line_end = (const char*)memchr(line, '\n', text + size - line);
+        if(!line_end) line_end = text + size;
+
+        Row row;
+        Platform platform;
+        if(parse_line(line, line_end, line_number, &row, &platform) && g_options.platforms[platform] && row_allowed(&row)) {
+            if(g_options.strip_names) row.name_len = 0;
+            add_row(&g_tables[platform], &row);
+        }
+
+        line = line_end + 1;
+    }
+
+    bool too_large = false;
+    for(int p = 0; p < Platform_COUNT; p++) {
+        if(!g_options.platforms[p]) continue;
+        // The library can't compile empty tables.
+        if(g_tables[p].num_rows == 0) fail("No mappings left for %s", g_platform_names[p]);
+        build_pool(&g_tables[p]);
+        build_indices(&g_tables[p]);
+        if(g_options.compress) compress_pool(&g_tables[p]);
+        print_size_report(&g_tables[p], (Platform)p);
+        if(g_options.max_size > 0 && table_size(&g_tables[p]) > (size_t)g_options.max_size) too_large = true;
+    }
+    if(too_large) fail("Over the size budget of %li bytes", g_options.max_size);
+
+    Buffer inl = {0};
+    write_inl(&inl);
+    const char* inl_path = g_options.output ? g_options.output : "gpad_gamecontrollerdb.inl";
+
+    if(g_options.check) {
+        size_t old_size = 0;
+        char* old = read_entire_file(inl_path, &old_size);
+        if(!old || old_size != inl.size || memcmp(old, inl.data, inl.size) != 0) {
+            fail("%s is out of date, run build_db", inl_path);
+        }
+        printf("%s is up to date\n", inl_path);
+        return 0;
+    }
+
+    if(!write_entire_file(inl_path, inl.data, inl.size)) {
+        fail("Couldn't write %s", inl_path);
+    }
+
+    for(int p = 0; p < Platform_COUNT; p++) {
+        if(!g_options.platforms[p] || g_options.output) continue;
+        char path[64];
+        snprintf(path, sizeof(path), "gpad_gamecontrollerdb_%s.bin", g_platform_files[p]);
+        Buffer db = {0};
+        write_database(&db, (Platform)p);
+        if(!write_entire_file(path, db.data, db.size)) {
+            fail("Couldn't write %s", path);
+        }
+    }
+
+    printf("FINISHED\n");
+    return 0;
+}
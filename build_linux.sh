@@ -0,0 +1,33 @@
+#!/bin/sh
+set -e
+
+# Regenerates gpad_gamecontrollerdb.inl from gamecontrollerdb.txt
+cc build_db/build_db.c -o build_db/build_db -std=c99 -O2
+./build_db/build_db
+
+cc -c gpad_linux.c -o gpad.o -std=c99 -D_DEFAULT_SOURCE -g -O0
+cc -c gpad_mapping.c -o gpad_mapping.o -std=c99 -D_DEFAULT_SOURCE -g -O0
+ar rcs libgpad_linux_x64_debug.a gpad.o gpad_mapping.o
+
+cc -c gpad_linux.c -o gpad.o -std=c99 -D_DEFAULT_SOURCE -O2
+cc -c gpad_mapping.c -o gpad_mapping.o -std=c99 -D_DEFAULT_SOURCE -O2
+ar rcs libgpad_linux_x64_release.a gpad.o gpad_mapping.o
+
+rm gpad.o gpad_mapping.o
+
+# Tests of the mapping evaluation, and benchmarks to run by hand with ./tests/gpad_bench
+cc tests/gpad_test.c gpad_linux.c gpad_mapping.c -o tests/gpad_test -std=c99 -D_DEFAULT_SOURCE -O2 -lm
+./tests/gpad_test
+# Same against a build_db --compress database, which decodes mappings through a small cache
+./build_db/build_db --platform linux --compress --output tests/gpad_gamecontrollerdb_compressed.inl
+cc tests/gpad_test.c gpad_linux.c gpad_mapping.c -o tests/gpad_test_compressed -std=c99 -D_DEFAULT_SOURCE -O2 -lm \
+    -DGPAD_DATABASE_INL='"tests/gpad_gamecontrollerdb_compressed.inl"'
+./tests/gpad_test_compressed
+cc tests/gpad_bench.c gpad_linux.c gpad_mapping.c -o tests/gpad_bench -std=c99 -D_DEFAULT_SOURCE -O2 -DGPAD_MAX_DEVICES=255
+
+# Tests of the backend on a virtual pad, once with epoll and once with io_uring. Skipped without access to /dev/uinput.
+cc tests/gpad_device_test.c gpad_linux.c gpad_mapping.c -o tests/gpad_device_test -std=c99 -D_DEFAULT_SOURCE -O2 -lm -lpthread
+./tests/gpad_device_test
+cc tests/gpad_device_test.c gpad_linux.c gpad_mapping.c -o tests/gpad_device_test_uring -std=c99 -D_DEFAULT_SOURCE -O2 \
+    -DGPAD_IO_URING -lm -lpthread
+./tests/gpad_device_test_uring
@@ -1,9 +1,15 @@
 @echo off
 
+rem Regenerates gpad_gamecontrollerdb.inl from gamecontrollerdb.txt
+cl build_db\build_db.c /Fobuild_db\build_db.obj /Febuild_db\build_db.exe /O2
+build_db\build_db.exe
+
 cl /c gpad_windows.c /I c\include /Fogpad.obj /Oi /MT /Zi /D_DEBUG /DEBUG
-lib /OUT:gpad_windows_x64_debug.lib gpad.obj
+cl /c gpad_mapping.c /I c\include /Fogpad_mapping.obj /Oi /MT /Zi /D_DEBUG /DEBUG
+lib /OUT:gpad_windows_x64_debug.lib gpad.obj gpad_mapping.obj
 
 cl /c gpad_windows.c /I c\include /Fogpad.obj /Oi /O2
-lib /OUT:gpad_windows_x64_release.lib gpad.obj
+cl /c gpad_mapping.c /I c\include /Fogpad_mapping.obj /Oi /O2
+lib /OUT:gpad_windows_x64_release.lib gpad.obj gpad_mapping.obj
 
-del gpad.obj
+del gpad.obj gpad_mapping.obj
@@ -9,6 +9,8 @@ main :: proc() {
     defer gpad.shutdown()
 
     for {
+        gpad.pump()
+
         for id: gpad.Device_Id = 0; id < gpad.MAX_DEVICES; id += 1 {
             if state, ok := gpad.poll(id); ok {
                 for axis in gpad.Axis {
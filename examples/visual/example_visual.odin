@@ -20,6 +20,7 @@ main :: proc() {
         defer rl.EndDrawing()
         rl.ClearBackground({20, 20, 30, 255})
         
+        gpad.pump()
         devices := gpad.list_devices_slice()
         
         state := gpad.poll(devices[0])
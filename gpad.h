@@ -1,6 +1,7 @@
 #ifndef GPAD_H_INCLUDED
 #define GPAD_H_INCLUDED
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifndef __cplusplus
@@ -11,7 +12,24 @@
 // Recieve device connected/disconnected events from the OS.
 //      windows: WM_DEVICECHANGE, RegisterDeviceNotification
 
+// Can be overridden, then the library and everything including gpad.h have to use the same value.
+// At most 255, GPAD_ID_INVALID is the largest Gpad_Device_Id.
+#ifndef GPAD_MAX_DEVICES
 #define GPAD_MAX_DEVICES 8
+#endif
+#if GPAD_MAX_DEVICES > 255
+#error "GPAD_MAX_DEVICES must be at most 255"
+#endif
+
+// Capacity for mappings loaded at runtime, on top of the built-in database. Used when building the library.
+#ifndef GPAD_MAX_RUNTIME_MAPPINGS
+#define GPAD_MAX_RUNTIME_MAPPINGS 1024
+#endif
+
+// Mappings kept decoded when the database was generated with build_db --compress. Used when building the library.
+#ifndef GPAD_MAX_DECODED_MAPPINGS
+#define GPAD_MAX_DECODED_MAPPINGS (GPAD_MAX_DEVICES * 2)
+#endif
 
 #define GPAD_AXIS_MAX 1.0f
 #define GPAD_AXIS_MIN -1.0f
@@ -21,6 +39,7 @@ typedef uint8_t Gpad_Button;
 typedef uint8_t Gpad_Axis;
 // Unique identifier for a device. Can be reused after a device is removed.
 typedef uint8_t Gpad_Device_Id;
+typedef uint8_t Gpad_Backend;
 
 // PS4 mappings:
 //      Cross:      A
@@ -62,26 +81,73 @@ typedef enum Gpad_Axis_ {
     Gpad_Axis_LAST = Gpad_Axis_Right_Trigger,
 } Gpad_Axis_;
 
+typedef enum Gpad_Backend_ {
+    // Best backend for the platform. Windows: XInput + DirectInput, Linux: evdev.
+    Gpad_Backend_Default = 0,
+    // Linux: /dev/input/event*
+    Gpad_Backend_Linux_Evdev = 1,
+    // Linux: legacy /dev/input/js* joystick API, for environments which only expose those nodes.
+    // No rumble, and buttons below BTN_MISC aren't reported by joydev.
+    Gpad_Backend_Linux_Joystick = 2,
+} Gpad_Backend_;
+
 typedef struct Gpad_Device_State {
     uint16_t buttons;
     float axes[Gpad_Axis_COUNT];
 } Gpad_Device_State;
 
+// Backend counters for profiling, they are never reset. Only tracked on Linux.
+typedef struct Gpad_Stats {
+    // read() calls on device fds, or completed io_uring reads with GPAD_IO_URING.
+    uint64_t read_calls;
+    // Input events returned by those calls. events_read / read_calls is the batching efficiency.
+    uint64_t events_read;
+} Gpad_Stats;
+
+// Called when a device gets a new ID (connected = true) or its ID becomes invalid (connected = false).
+typedef void (*Gpad_Device_Callback)(Gpad_Device_Id id, bool connected, void* user_data);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Also loads the mappings in the SDL_GAMECONTROLLERCONFIG environment variable, if set.
 bool gpad_initialize(void);
+// Same as gpad_initialize with an explicit backend. Returns false if the backend isn't supported on this platform.
+bool gpad_initialize_backend(Gpad_Backend backend);
 void gpad_shutdown(void);
 // Returns true if the context was correctly initialized.
 bool gpad_is_initialized(void);
 // Scan for all the connected devices. This is a slow operation, don't call every frame!!!
 void gpad_refresh_connected_devices(void);
+// Read pending input of all devices. Call once per frame before polling.
+// On Linux this is the only place which touches the devices, gpad_poll_device then returns the cached state.
+// On Windows devices are read in gpad_poll_device and this does nothing.
+void gpad_pump(void);
 // Poll the device state. This should probably be called once per frame for each used controller and cached.
 bool gpad_poll_device(Gpad_Device_Id id, Gpad_Device_State* out_state);
 // Vibrate the controller. On Xbox, the left motor is low frequency and the high motor high frequency.
 bool gpad_rumble_device(Gpad_Device_Id id, float low_frequency, float high_frequency);
 bool gpad_device_valid(Gpad_Device_Id id);
+// Set a callback for device connect/disconnect, pass 0 to remove it. Can be set before gpad_initialize.
+// The callback is invoked from gpad_pump, gpad_poll_device and gpad_refresh_connected_devices.
+// On Linux new devices are detected in gpad_pump, without the need to call gpad_refresh_connected_devices.
+// On Windows only devices which fail to poll are reported, new devices still require a refresh.
+void gpad_set_device_callback(Gpad_Device_Callback callback, void* user_data);
+// Load mappings in the SDL gamecontrollerdb.txt format, one per line. Can be called before gpad_initialize.
+// Lines for other platforms are skipped. A mapping replaces the built-in one and any earlier loaded one with the same GUID.
+// Connected devices switch to the new mappings right away.
+// At most GPAD_MAX_RUNTIME_MAPPINGS different GUIDs can be loaded, the rest is ignored.
+// Returns the number of mappings loaded, or -1 if the data couldn't be read.
+int gpad_load_mappings_from_memory(const char* data, size_t size);
+int gpad_load_mappings_from_file(const char* path);
+// Add or replace a single mapping, one line in the gamecontrollerdb.txt format. The platform field is optional.
+// Returns false if the line couldn't be parsed, is for another platform or the runtime storage is full.
+bool gpad_add_mapping(const char* mapping);
+// Replace the built-in database with a precompiled one generated by build_db (gpad_gamecontrollerdb_<platform>.bin).
+// The file is mapped read-only and used in place. Must be called before gpad_initialize.
+// Returns false and keeps the current database if the file is for another platform, or its version or checksum don't match.
+bool gpad_load_database_file(const char* path);
 
 //
 // Utilities
@@ -89,6 +155,7 @@ bool gpad_device_valid(Gpad_Device_Id id);
 
 const char* gpad_button_name(Gpad_Button button);
 const char* gpad_axis_name(Gpad_Axis axis);
+void gpad_get_stats(Gpad_Stats* out_stats);
 // Get a list of all valid device IDs. Returns number of devices written.
 int gpad_list_devices(Gpad_Device_Id* ids, int ids_max);
 // Utility for checking if a button is pressed.
@@ -4,13 +4,19 @@ import "core:c"
 
 // These definitions must be the same as in gpad.h!
 
-MAX_DEVICES :: 8
+MAX_DEVICES :: 8 // GPAD_MAX_DEVICES the library was built with
 ID_INVALID :: ~Device_Id(0)
 AXIS_MAX :: 1.0
 AXIS_MIN :: -1.0
 
 Device_Id :: distinct u8
 
+Backend :: enum u8 {
+    Default        = 0,
+    Linux_Evdev    = 1,
+    Linux_Joystick = 2,
+}
+
 // PS4 layout:
 //      Cross:      A
 //      Circle:     B
@@ -43,6 +49,13 @@ Axis :: enum u8 {
     Right_Trigger = 5,
 }
 
+Stats :: struct {
+    read_calls:  u64,
+    events_read: u64,
+}
+
+Device_Callback :: #type proc "c" (device: Device_Id, connected: bool, user_data: rawptr)
+
 Device_State :: struct {
     buttons: bit_set[Button;u16],
     axes:    [Axis]f32,
@@ -54,19 +67,34 @@ when ODIN_OS == .Windows {
     } else {
         foreign import lib "gpad_windows_x64_release.lib"
     }
+} else when ODIN_OS == .Linux {
+    // Build with build_linux.sh first.
+    when ODIN_DEBUG {
+        foreign import lib "libgpad_linux_x64_debug.a"
+    } else {
+        foreign import lib "libgpad_linux_x64_release.a"
+    }
 }
 
 @(default_calling_convention = "c", link_prefix = "gpad_")
 foreign lib {
     initialize :: proc() ---
+    initialize_backend :: proc(backend: Backend) -> bool ---
     shutdown :: proc() ---
     is_initialized :: proc() -> bool ---
     refresh_connected_devices :: proc() ---
+    pump :: proc() ---
+    set_device_callback :: proc(callback: Device_Callback, user_data: rawptr) ---
+    load_mappings_from_memory :: proc(data: [^]u8, size: c.size_t) -> c.int ---
+    load_mappings_from_file :: proc(path: cstring) -> c.int ---
+    add_mapping :: proc(mapping: cstring) -> bool ---
+    load_database_file :: proc(path: cstring) -> bool ---
     poll_device :: proc(device: Device_Id, out_state: ^Device_State) -> bool ---
     rumble_device :: proc(device: Device_Id, low_frequency: f32, high_frequency: f32) -> bool ---
 
     // Utilities
 
+    get_stats :: proc(out_stats: ^Stats) ---
     list_devices :: proc(devices: [^]Device_Id, max_devices: c.int) -> c.int ---
     button_name :: proc(button: Button) -> cstring ---
     axis_name :: proc(axis: Axis) -> cstring ---
@@ -78,6 +106,10 @@ poll :: proc(device: Device_Id) -> (result: Device_State, ok: bool) #optional_ok
     return
 }
 
+load_mappings :: proc(data: []u8) -> int {
+    return int(load_mappings_from_memory(raw_data(data), c.size_t(len(data))))
+}
+
 list_devices_slice :: proc(allocator := context.temp_allocator) -> []Device_Id {
     buf := new([MAX_DEVICES]Device_Id, allocator)
     num := list_devices(&buf[0], MAX_DEVICES)
@@ -0,0 +1,1351 @@
+#if __linux__
+#define GPAD_PLATFORM_LINUX
+#include "gpad.h"
+#include "gpad_mapping.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <linux/input.h>
+#include <linux/joystick.h>
+
+#ifdef GPAD_IO_URING
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#define GPAD__RAW_INDEX_INVALID 0xff
+
+// js_event.number is 8 bits.
+#define GPAD__MAX_JS_BUTTONS 256
+
+// Events per read(). A 1 kHz pad left alone for a frame queues a few hundred, this drains them in one syscall.
+#define GPAD__READ_BUFFER_EVENTS 512
+
+// epoll event data of the /dev/input watch, devices use their ID.
+#define GPAD__EPOLL_HOTPLUG 0xffffffffu
+
+#ifdef GPAD_IO_URING
+// One read and one cancel per device plus the hotplug poll, the kernel rounds it up to a power of two.
+// Churn between two pumps can queue more, gpad__uring_get_sqe submits early then.
+#define GPAD__URING_ENTRIES (2 * GPAD_MAX_DEVICES + 1)
+#define GPAD__URING_READ_EVENTS 256
+
+// user_data of requests which aren't device reads. Reads use (generation << 8) | id.
+#define GPAD__URING_HOTPLUG 0xffffffffffffffffull
+#define GPAD__URING_CANCEL 0xfffffffffffffffeull
+#endif
+
+#define GPAD__BITS_PER_LONG (sizeof(unsigned long) * 8)
+#define GPAD__NUM_LONGS(bits) (((bits) + GPAD__BITS_PER_LONG - 1) / GPAD__BITS_PER_LONG)
+
+// From the absinfo. Values within center +- flat snap to center, applied to incoming events.
+typedef struct Gpad_Axis_Flat {
+    int32_t center;
+    int32_t flat;
+} Gpad_Axis_Flat;
+
+typedef uint8_t Gpad_Device_Entry_Kind;
+
+typedef enum Gpad_Device_Entry_Kind_ {
+    // /dev/input/event*
+    Gpad_Device_Entry_Kind_Evdev,
+    // /dev/input/js*, the legacy joystick API.
+    Gpad_Device_Entry_Kind_Joystick,
+} Gpad_Device_Entry_Kind_;
+
+typedef struct Gpad_Device_Entry {
+    Gpad_Mapping_Index mapping_index;
+    Gpad_Device_Entry_Kind kind;
+    int fd;
+    // Effect id assigned by the kernel on upload, -1 if there is none yet.
+    // The effect is uploaded once and then only updated when the magnitudes change.
+    int16_t ff_effect_id;
+    bool has_rumble;
+    bool rumble_playing;
+    uint16_t rumble_strong;
+    uint16_t rumble_weak;
+
+    // Set between SYN_DROPPED and the following SYN_REPORT.
+    bool syn_dropped;
+
+    // Raw device state in SDL joystick order, this is what the mappings index into.
+    // Anything above the GPAD__MAX_RAW_* limits is ignored, the SDL mappings never go this high.
+    Gpad_Raw_State raw;
+    Gpad_Axis_Calibration axis_calibration[GPAD__MAX_RAW_AXES];
+    Gpad_Axis_Flat axis_flat[GPAD__MAX_RAW_AXES];
+    int8_t hat_values[GPAD__MAX_RAW_HATS][2];
+
+    // evdev code => raw index, GPAD__RAW_INDEX_INVALID if unused.
+    uint8_t key_map[KEY_CNT];
+    uint8_t abs_map[ABS_CNT];
+
+    // Joystick API only: js button/axis number => evdev code, so js events go through the same path.
+    uint16_t js_key_codes[GPAD__MAX_JS_BUTTONS];
+    uint8_t js_abs_codes[ABS_CNT];
+
+    // Compiled from the mapping on connect and when runtime mappings change.
+    Gpad_Compiled_Mapping mapping;
+    // Mapped state, updated by gpad_pump.
+    Gpad_Device_State state;
+    // Raw input arrived during this gpad_pump, the state is updated at the end.
+    bool input_changed;
+
+    dev_t rdev;
+    char path[32];
+    Gpad_Guid guid;
+} Gpad_Device_Entry;
+
+#ifdef GPAD_IO_URING
+typedef struct Gpad_Uring_Slot {
+    // Owned by the kernel while the read is in flight, so it can't be reused before the completion arrives.
+    struct input_event events[GPAD__URING_READ_EVENTS];
+    // Bumped for every device opened in the slot, completions of older reads are dropped.
+    uint32_t generation;
+    bool in_flight;
+} Gpad_Uring_Slot;
+
+typedef struct Gpad_Uring {
+    int fd;
+    // Submissions not yet passed to io_uring_enter.
+    unsigned int to_submit;
+    // A read couldn't be queued, gpad__uring_pump retries all devices without one.
+    bool rearm;
+
+    unsigned int* sq_head;
+    unsigned int* sq_tail;
+    unsigned int* sq_mask;
+    unsigned int* sq_array;
+    struct io_uring_sqe* sqes;
+
+    unsigned int* cq_head;
+    unsigned int* cq_tail;
+    unsigned int* cq_mask;
+    struct io_uring_cqe* cqes;
+
+    void* sq_ring;
+    size_t sq_ring_size;
+    void* cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+
+    Gpad_Uring_Slot slots[GPAD_MAX_DEVICES];
+} Gpad_Uring;
+#endif
+
+typedef struct Gpad_Context {
+    bool initialized;
+    Gpad_Backend backend;
+
+    // All open device fds, the event data is the device ID.
+    int epoll_fd;
+    // Watches /dev/input for added and removed nodes, -1 if not available.
+    int inotify_fd;
+    Gpad_Device_Entry id_entries[GPAD_MAX_DEVICES];
+
+    Gpad_Device_Callback device_callback;
+    void* device_callback_user_data;
+
+    Gpad_Stats stats;
+
+    // Axes of all devices, evaluated together at the end of gpad_pump.
+    Gpad_Axis_Batch axis_batch;
+    // Set when a device or mapping changed, the batch is rebuilt before it's used next.
+    bool axis_batch_dirty;
+
+#ifdef GPAD_IO_URING
+    // False if io_uring isn't available, then the epoll path is used.
+    bool use_uring;
+    Gpad_Uring uring;
+#endif
+} Gpad_Context;
+
+static Gpad_Context gpad__context = {0};
+
+#ifdef GPAD_IO_URING
+static void gpad__uring_arm_read(const Gpad_Device_Id id);
+static void gpad__uring_cancel_read(const Gpad_Device_Id id);
+#endif
+
+static bool gpad__test_bit(const unsigned long* bits, const unsigned int bit) {
+    return (bits[bit / GPAD__BITS_PER_LONG] >> (bit % GPAD__BITS_PER_LONG)) & 1;
+}
+
+static void gpad__reset_device_entry(Gpad_Device_Entry* entry) {
+    memset(entry, 0, sizeof(Gpad_Device_Entry));
+    entry->mapping_index = GPAD_MAPPING_INDEX_INVALID;
+    entry->fd = -1;
+    entry->ff_effect_id = -1;
+    gpad__context.axis_batch_dirty = true;
+}
+
+static void gpad__remove_device_entry(const Gpad_Device_Id id) {
+    if(id < GPAD_MAX_DEVICES) {
+        Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
+        if(entry->fd >= 0) {
+#ifdef GPAD_IO_URING
+            if(gpad__context.use_uring) {
+                gpad__uring_cancel_read(id);
+            }
+#endif
+            epoll_ctl(gpad__context.epoll_fd, EPOLL_CTL_DEL, entry->fd, 0);
+            close(entry->fd);
+        }
+        gpad__reset_device_entry(entry);
+    }
+}
+
+static void gpad__update_state(Gpad_Device_Entry* entry);
+
+static Gpad_Device_Id gpad__find_unused_device_id(void) {
+    for(int id = 0; id < GPAD_MAX_DEVICES; id++) {
+        if(gpad__context.id_entries[id].mapping_index == GPAD_MAPPING_INDEX_INVALID) {
+            return id;
+        }
+    }
+
+    return GPAD_ID_INVALID;
+}
+
+// Hat bits as used by the SDL mappings.
+static uint8_t gpad__hat_bits(const int8_t x, const int8_t y) {
+    uint8_t result = 0;
+    if(y < 0) result |= 1; // Up
+    if(x > 0) result |= 2; // Right
+    if(y > 0) result |= 4; // Down
+    if(x < 0) result |= 8; // Left
+    return result;
+}
+
+// Same heuristic as SDL: anything with a joystick/gamepad button and at least one absolute axis.
+static bool gpad__is_gamepad(const unsigned long* ev_bits, const unsigned long* key_bits, const unsigned long* abs_bits) {
+    if(!gpad__test_bit(ev_bits, EV_KEY) || !gpad__test_bit(ev_bits, EV_ABS)) return false;
+
+    bool has_button = false;
+    for(unsigned int code = BTN_JOYSTICK; code <= BTN_THUMBR; code++) {
+        if(gpad__test_bit(key_bits, code)) {
+            has_button = true;
+            break;
+        }
+    }
+
+    return has_button && (gpad__test_bit(abs_bits, ABS_X) || gpad__test_bit(abs_bits, ABS_HAT0X));
+}
+
+// CRC-16/ARC as used by SDL_crc16.
+static uint16_t gpad__crc16(const char* data, const size_t len) {
+    uint16_t crc = 0;
+    for(size_t i = 0; i < len; i++) {
+        uint8_t r = (uint8_t)crc ^ (uint8_t)data[i];
+        uint16_t byte_crc = 0;
+        for(int bit = 0; bit < 8; bit++) {
+            byte_crc = (((byte_crc ^ r) & 1) ? 0xA001 : 0) ^ (byte_crc >> 1);
+            r >>= 1;
+        }
+        crc = byte_crc ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static void gpad__write_u16(uint8_t* dst, const uint16_t value) {
+    dst[0] = (uint8_t)(value >> 0);
+    dst[1] = (uint8_t)(value >> 8);
+}
+
+// Generate a joystick GUID that matches the SDL 2.26+ one, including the CRC of the device name in bytes 2-3.
+// Older database rows have zero there, see gpad__resolve_mapping.
+static void gpad__make_guid(Gpad_Guid* guid, const struct input_id* input_id, const char* name) {
+    memset(guid, 0, sizeof(Gpad_Guid));
+    gpad__write_u16(&guid->data[0], input_id->bustype);
+    gpad__write_u16(&guid->data[2], gpad__crc16(name, strlen(name)));
+
+    if(input_id->vendor && input_id->product) {
+        gpad__write_u16(&guid->data[4], input_id->vendor);
+        gpad__write_u16(&guid->data[8], input_id->product);
+        gpad__write_u16(&guid->data[12], input_id->version);
+    } else {
+        // Same as SDL: no IDs, so the name has to identify the device.
+        snprintf((char*)&guid->data[4], 12, "%s", name);
+    }
+}
+
+// Maps [minimum, maximum] to [-1, 1]. Degenerate axes always read 0.
+static Gpad_Axis_Calibration gpad__make_axis_calibration(const struct input_absinfo* absinfo) {
+    Gpad_Axis_Calibration result = {0};
+    if(absinfo->maximum > absinfo->minimum) {
+        result.scale = 2.0f / ((float)absinfo->maximum - (float)absinfo->minimum);
+        result.bias = -(float)absinfo->minimum * result.scale - 1.0f;
+    }
+    return result;
+}
+
+static Gpad_Axis_Flat gpad__make_axis_flat(const struct input_absinfo* absinfo) {
+    Gpad_Axis_Flat result;
+    result.center = (int32_t)(((int64_t)absinfo->minimum + (int64_t)absinfo->maximum) / 2);
+    result.flat = absinfo->flat > 0 ? absinfo->flat : -1;
+    return result;
+}
+
+static void gpad__apply_event(Gpad_Device_Entry* entry, const struct input_event* event) {
+    switch(event->type) {
+        case EV_KEY: {
+            if(event->code >= KEY_CNT) break;
+            const uint8_t button = entry->key_map[event->code];
+            if(button == GPAD__RAW_INDEX_INVALID) break;
+
+            // Value 2 is autorepeat, treat it as held.
+            if(event->value) {
+                entry->raw.buttons |= (uint64_t)1 << button;
+            } else {
+                entry->raw.buttons &= ~((uint64_t)1 << button);
+            }
+        } break;
+
+        case EV_ABS: {
+            if(event->code >= ABS_CNT) break;
+            const uint8_t index = entry->abs_map[event->code];
+            if(index == GPAD__RAW_INDEX_INVALID) break;
+
+            if(event->code >= ABS_HAT0X && event->code <= ABS_HAT3Y) {
+                const int component = (event->code - ABS_HAT0X) & 1;
+                entry->hat_values[index][component] = event->value < 0 ? -1 : (event->value > 0 ? 1 : 0);
+                entry->raw.hats[index] = gpad__hat_bits(entry->hat_values[index][0], entry->hat_values[index][1]);
+            } else {
+                const Gpad_Axis_Flat* flat = &entry->axis_flat[index];
+                int32_t value = event->value;
+                if(value >= flat->center - flat->flat && value <= flat->center + flat->flat) {
+                    value = flat->center;
+                }
+                entry->raw.axes[index] = value;
+            }
+        } break;
+    }
+}
+
+// Re-reads the complete raw state in one go. Used on open and after the kernel dropped events.
+static void gpad__resync_device(Gpad_Device_Entry* entry) {
+    unsigned long key_state[GPAD__NUM_LONGS(KEY_CNT)] = {0};
+    if(ioctl(entry->fd, EVIOCGKEY(sizeof(key_state)), key_state) >= 0) {
+        entry->raw.buttons = 0;
+        for(unsigned int code = 0; code < KEY_CNT; code++) {
+            const uint8_t button = entry->key_map[code];
+            if(button != GPAD__RAW_INDEX_INVALID && gpad__test_bit(key_state, code)) {
+                entry->raw.buttons |= (uint64_t)1 << button;
+            }
+        }
+    }
+
+    for(unsigned int code = 0; code < ABS_CNT; code++) {
+        if(entry->abs_map[code] == GPAD__RAW_INDEX_INVALID) continue;
+
+        struct input_absinfo absinfo = {0};
+        if(ioctl(entry->fd, EVIOCGABS(code), &absinfo) < 0) continue;
+
+        struct input_event event = {0};
+        event.type = EV_ABS;
+        event.code = (uint16_t)code;
+        event.value = absinfo.value;
+        gpad__apply_event(entry, &event);
+    }
+}
+
+static bool gpad__device_path_open(const char* path, const dev_t rdev) {
+    for(int id = 0; id < GPAD_MAX_DEVICES; id++) {
+        const Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
+        if(entry->mapping_index == GPAD_MAPPING_INDEX_INVALID) continue;
+        if(entry->rdev == rdev && strcmp(entry->path, path) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Everything needed to set up a device entry, queried from either API.
+typedef struct Gpad_Device_Info {
+    unsigned long key_bits[GPAD__NUM_LONGS(KEY_CNT)];
+    unsigned long abs_bits[GPAD__NUM_LONGS(ABS_CNT)];
+    struct input_absinfo absinfo[ABS_CNT];
+    Gpad_Guid guid;
+    bool has_rumble;
+
+    // Joystick API only: js button/axis number => evdev code.
+    uint16_t js_key_codes[GPAD__MAX_JS_BUTTONS];
+    uint8_t js_abs_codes[ABS_CNT];
+} Gpad_Device_Info;
+
+static bool gpad__query_evdev(const int fd, Gpad_Device_Info* info) {
+    unsigned long ev_bits[GPAD__NUM_LONGS(EV_CNT)] = {0};
+    unsigned long ff_bits[GPAD__NUM_LONGS(FF_CNT)] = {0};
+    struct input_id input_id = {0};
+    char name[128] = "";
+
+    if(ioctl(fd, EVIOCGBIT(0, sizeof(ev_bits)), ev_bits) < 0 ||
+       ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(info->key_bits)), info->key_bits) < 0 ||
+       ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(info->abs_bits)), info->abs_bits) < 0 ||
+       ioctl(fd, EVIOCGID, &input_id) < 0 || !gpad__is_gamepad(ev_bits, info->key_bits, info->abs_bits)) {
+        return false;
+    }
+
+    // The name is optional, it's only used for the GUID.
+    if(ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name) < 0) {
+        name[0] = 0;
+    }
+    gpad__make_guid(&info->guid, &input_id, name);
+
+    for(unsigned int code = 0; code < ABS_CNT; code++) {
+        if(!gpad__test_bit(info->abs_bits, code)) continue;
+        if(ioctl(fd, EVIOCGABS(code), &info->absinfo[code]) < 0) {
+            info->abs_bits[code / GPAD__BITS_PER_LONG] &= ~(1ul << (code % GPAD__BITS_PER_LONG));
+        }
+    }
+
+    // Force feedback also needs write access, which is checked on the first upload.
+    info->has_rumble = gpad__test_bit(ev_bits, EV_FF) && ioctl(fd, EVIOCGBIT(EV_FF, sizeof(ff_bits)), ff_bits) >= 0 &&
+                       gpad__test_bit(ff_bits, FF_RUMBLE);
+    return true;
+}
+
+// Reads a hex value from /sys/class/input/<node>/device/id/<field>. Returns 0 on failure.
+static uint16_t gpad__read_sysfs_id(const char* node, const char* field) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/class/input/%s/device/id/%s", node, field);
+
+    FILE* file = fopen(path, "r");
+    if(!file) return 0;
+
+    unsigned int value = 0;
+    if(fscanf(file, "%x", &value) != 1) {
+        value = 0;
+    }
+    fclose(file);
+    return (uint16_t)value;
+}
+
+static bool gpad__query_joystick(const int fd, const char* path, Gpad_Device_Info* info) {
+    uint8_t num_axes = 0;
+    uint8_t num_buttons = 0;
+    uint16_t key_codes[KEY_MAX - BTN_MISC + 1] = {0};
+    char name[128] = "";
+
+    if(ioctl(fd, JSIOCGAXES, &num_axes) < 0 || ioctl(fd, JSIOCGBUTTONS, &num_buttons) < 0 ||
+       ioctl(fd, JSIOCGAXMAP, info->js_abs_codes) < 0 || ioctl(fd, JSIOCGBTNMAP, key_codes) < 0) {
+        return false;
+    }
+
+    if(ioctl(fd, JSIOCGNAME(sizeof(name) - 1), name) < 0) {
+        name[0] = 0;
+    }
+
+    // The joystick API has no IDs, take them from the parent input device. Without sysfs (some containers)
+    // this falls back to the name based GUID.
+    const char* node = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    struct input_id input_id = {0};
+    input_id.bustype = gpad__read_sysfs_id(node, "bustype");
+    input_id.vendor = gpad__read_sysfs_id(node, "vendor");
+    input_id.product = gpad__read_sysfs_id(node, "product");
+    input_id.version = gpad__read_sysfs_id(node, "version");
+    gpad__make_guid(&info->guid, &input_id, name);
+
+    // Rebuild the evdev capability bits, so the raw indices come out the same as with the evdev backend.
+    for(int i = 0; i < num_buttons && i < GPAD__MAX_JS_BUTTONS; i++) {
+        const uint16_t code = key_codes[i];
+        info->js_key_codes[i] = code;
+        if(code < KEY_CNT) {
+            info->key_bits[code / GPAD__BITS_PER_LONG] |= 1ul << (code % GPAD__BITS_PER_LONG);
+        }
+    }
+
+    // joydev already scales every axis to this range.
+    for(int i = 0; i < num_axes && i < ABS_CNT; i++) {
+        const uint8_t code = info->js_abs_codes[i];
+        if(code >= ABS_CNT) continue;
+        info->abs_bits[code / GPAD__BITS_PER_LONG] |= 1ul << (code % GPAD__BITS_PER_LONG);
+        info->absinfo[code].minimum = -32767;
+        info->absinfo[code].maximum = 32767;
+    }
+    for(int i = num_axes; i < ABS_CNT; i++) {
+        info->js_abs_codes[i] = ABS_CNT;
+    }
+
+    // No force feedback through the joystick API.
+    info->has_rumble = false;
+    return num_buttons > 0 || num_axes > 0;
+}
+
+// Numbers the raw buttons, axes and hats the same way SDL does, this is what the mappings index into.
+static void gpad__init_layout(Gpad_Device_Entry* entry, const Gpad_Device_Info* info) {
+    memset(entry->key_map, GPAD__RAW_INDEX_INVALID, sizeof(entry->key_map));
+    memset(entry->abs_map, GPAD__RAW_INDEX_INVALID, sizeof(entry->abs_map));
+
+    // Joystick/gamepad buttons first, then everything below BTN_JOYSTICK.
+    int num_buttons = 0;
+    for(unsigned int code = BTN_JOYSTICK; code < KEY_MAX && num_buttons < GPAD__MAX_RAW_BUTTONS; code++) {
+        if(gpad__test_bit(info->key_bits, code)) {
+            entry->key_map[code] = (uint8_t)num_buttons++;
+        }
+    }
+    for(unsigned int code = 0; code < BTN_JOYSTICK && num_buttons < GPAD__MAX_RAW_BUTTONS; code++) {
+        if(gpad__test_bit(info->key_bits, code)) {
+            entry->key_map[code] = (uint8_t)num_buttons++;
+        }
+    }
+
+    int num_axes = 0;
+    for(unsigned int code = 0; code < ABS_MAX && num_axes < GPAD__MAX_RAW_AXES; code++) {
+        // Hats are reported separately.
+        if(code >= ABS_HAT0X && code <= ABS_HAT3Y) continue;
+        if(!gpad__test_bit(info->abs_bits, code)) continue;
+
+        const int axis = num_axes++;
+        entry->abs_map[code] = (uint8_t)axis;
+        entry->axis_calibration[axis] = gpad__make_axis_calibration(&info->absinfo[code]);
+        entry->axis_flat[axis] = gpad__make_axis_flat(&info->absinfo[code]);
+    }
+
+    int num_hats = 0;
+    for(unsigned int code = ABS_HAT0X; code <= ABS_HAT3Y && num_hats < GPAD__MAX_RAW_HATS; code += 2) {
+        if(gpad__test_bit(info->abs_bits, code) || gpad__test_bit(info->abs_bits, code + 1)) {
+            entry->abs_map[code] = (uint8_t)num_hats;
+            entry->abs_map[code + 1] = (uint8_t)num_hats;
+            num_hats++;
+        }
+    }
+}
+
+static void gpad__append_generic_button(char** fields, char* end, const char* name, const Gpad_Device_Entry* entry, const unsigned int code) {
+    if(entry->key_map[code] != GPAD__RAW_INDEX_INVALID) {
+        *fields += snprintf(*fields, end - *fields, "%s:b%i,", name, entry->key_map[code]);
+    }
+}
+
+static void gpad__append_generic_axis(char** fields, char* end, const char* name, const Gpad_Device_Entry* entry, const unsigned int code) {
+    if(entry->abs_map[code] != GPAD__RAW_INDEX_INVALID) {
+        *fields += snprintf(*fields, end - *fields, "%s:a%i,", name, entry->abs_map[code]);
+    }
+}
+
+// Layout for devices with no database entry, guessed from the evdev codes after the kernel gamepad API, like SDL.
+// Must run after gpad__init_layout.
+static void gpad__make_generic_fields(const Gpad_Device_Entry* entry, char* fields, const size_t size) {
+    char* end = fields + size;
+    fields[0] = 0;
+    gpad__append_generic_button(&fields, end, "a", entry, BTN_SOUTH);
+    gpad__append_generic_button(&fields, end, "b", entry, BTN_EAST);
+    // Sony uses the kernel names, others report their X/Y labels which are swapped relative to them.
+    const bool sony = entry->guid.data[4] == 0x4c && entry->guid.data[5] == 0x05;
+    gpad__append_generic_button(&fields, end, "x", entry, sony ? BTN_WEST : BTN_X);
+    gpad__append_generic_button(&fields, end, "y", entry, sony ? BTN_NORTH : BTN_Y);
+    gpad__append_generic_button(&fields, end, "leftshoulder", entry, BTN_TL);
+    gpad__append_generic_button(&fields, end, "rightshoulder", entry, BTN_TR);
+    gpad__append_generic_button(&fields, end, "back", entry, BTN_SELECT);
+    gpad__append_generic_button(&fields, end, "start", entry, BTN_START);
+    gpad__append_generic_button(&fields, end, "guide", entry, BTN_MODE);
+    gpad__append_generic_button(&fields, end, "leftstick", entry, BTN_THUMBL);
+    gpad__append_generic_button(&fields, end, "rightstick", entry, BTN_THUMBR);
+
+    if(entry->key_map[BTN_DPAD_UP] != GPAD__RAW_INDEX_INVALID) {
+        gpad__append_generic_button(&fields, end, "dpup", entry, BTN_DPAD_UP);
+        gpad__append_generic_button(&fields, end, "dpright", entry, BTN_DPAD_RIGHT);
+        gpad__append_generic_button(&fields, end, "dpdown", entry, BTN_DPAD_DOWN);
+        gpad__append_generic_button(&fields, end, "dpleft", entry, BTN_DPAD_LEFT);
+    } else if(entry->abs_map[ABS_HAT0X] != GPAD__RAW_INDEX_INVALID) {
+        const int hat = entry->abs_map[ABS_HAT0X];
+        fields += snprintf(fields, end - fields, "dpup:h%i.1,dpright:h%i.2,dpdown:h%i.4,dpleft:h%i.8,", hat, hat, hat, hat);
+    }
+
+    gpad__append_generic_axis(&fields, end, "leftx", entry, ABS_X);
+    gpad__append_generic_axis(&fields, end, "lefty", entry, ABS_Y);
+    if(entry->abs_map[ABS_RX] != GPAD__RAW_INDEX_INVALID && entry->abs_map[ABS_RY] != GPAD__RAW_INDEX_INVALID) {
+        gpad__append_generic_axis(&fields, end, "rightx", entry, ABS_RX);
+        gpad__append_generic_axis(&fields, end, "righty", entry, ABS_RY);
+        gpad__append_generic_axis(&fields, end, "lefttrigger", entry, ABS_Z);
+        gpad__append_generic_axis(&fields, end, "righttrigger", entry, ABS_RZ);
+    } else {
+        // Older HID gamepads put the right stick on Z/RZ.
+        gpad__append_generic_axis(&fields, end, "rightx", entry, ABS_Z);
+        gpad__append_generic_axis(&fields, end, "righty", entry, ABS_RZ);
+    }
+    if(entry->abs_map[ABS_Z] == GPAD__RAW_INDEX_INVALID || entry->abs_map[ABS_RX] == GPAD__RAW_INDEX_INVALID) {
+        gpad__append_generic_button(&fields, end, "lefttrigger", entry, BTN_TL2);
+        gpad__append_generic_button(&fields, end, "righttrigger", entry, BTN_TR2);
+    }
+}
+
+// Opens the device node of the active backend and fills in the raw layout.
+// Returns false if it isn't a supported gamepad.
+static bool gpad__open_device(const Gpad_Device_Id id, const char* path) {
+    Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
+    const bool joystick = gpad__context.backend == Gpad_Backend_Linux_Joystick;
+
+    // Read-write is needed for force feedback, but input alone works with read-only access.
+    int fd = joystick ? -1 : open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if(fd < 0) {
+        fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    }
+    if(fd < 0) {
+        return false;
+    }
+
+    Gpad_Device_Info info;
+    memset(&info, 0, sizeof(info));
+    struct stat st;
+
+    const bool supported = joystick ? gpad__query_joystick(fd, path, &info) : gpad__query_evdev(fd, &info);
+    if(!supported || fstat(fd, &st) < 0) {
+        close(fd);
+        return false;
+    }
+
+    int mapping_index = gpad__resolve_mapping(&info.guid);
+
+#ifdef GPAD_IO_URING
+    if(gpad__context.use_uring) {
+        // io_uring completes reads on O_NONBLOCK files with -EAGAIN instead of waiting for input.
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    } else
+#endif
+    {
+        struct epoll_event epoll_event = {0};
+        epoll_event.events = EPOLLIN;
+        epoll_event.data.u32 = id;
+        if(epoll_ctl(gpad__context.epoll_fd, EPOLL_CTL_ADD, fd, &epoll_event) < 0) {
+            close(fd);
+            return false;
+        }
+    }
+
+    gpad__reset_device_entry(entry);
+    entry->kind = joystick ? Gpad_Device_Entry_Kind_Joystick : Gpad_Device_Entry_Kind_Evdev;
+    entry->fd = fd;
+    entry->has_rumble = info.has_rumble;
+    entry->rdev = st.st_rdev;
+    snprintf(entry->path, sizeof(entry->path), "%s", path);
+    entry->guid = info.guid;
+    memcpy(entry->js_key_codes, info.js_key_codes, sizeof(entry->js_key_codes));
+    memcpy(entry->js_abs_codes, info.js_abs_codes, sizeof(entry->js_abs_codes));
+    gpad__init_layout(entry, &info);
+
+    if(mapping_index < 0) {
+        // At most around 300 bytes, every field appears once.
+        char fields[512];
+        gpad__make_generic_fields(entry, fields, sizeof(fields));
+        mapping_index = gpad__add_generic_mapping(&info.guid, fields);
+        if(mapping_index < 0) {
+            gpad__remove_device_entry(id);
+            return false;
+        }
+    }
+    entry->mapping_index = (Gpad_Mapping_Index)mapping_index;
+    gpad__compile_mapping(gpad__get_mapping(entry->mapping_index), entry->axis_calibration, &entry->mapping);
+
+    // joydev sends the full state as JS_EVENT_INIT events on the first read, evdev has to be asked.
+    if(!joystick) {
+        gpad__resync_device(entry);
+    }
+    gpad__update_state(entry);
+
+#ifdef GPAD_IO_URING
+    if(gpad__context.use_uring) {
+        gpad__context.uring.slots[id].generation++;
+        gpad__uring_arm_read(id);
+    }
+#endif
+
+    return true;
+}
+
+static void gpad__apply_events(Gpad_Device_Entry* entry, const struct input_event* events, const int num_events) {
+    gpad__context.stats.events_read += num_events;
+    for(int i = 0; i < num_events; i++) {
+        const struct input_event* event = &events[i];
+
+        // After SYN_DROPPED the kernel queue overflowed and the incremental state is wrong.
+        // Everything up to the next SYN_REPORT belongs to the broken frame, so skip it and re-read the device.
+        if(event->type == EV_SYN) {
+            if(event->code == SYN_DROPPED) {
+                entry->syn_dropped = true;
+            } else if(event->code == SYN_REPORT && entry->syn_dropped) {
+                entry->syn_dropped = false;
+                gpad__resync_device(entry);
+            }
+            continue;
+        }
+
+        if(!entry->syn_dropped) {
+            gpad__apply_event(entry, event);
+        }
+    }
+}
+
+// Reads everything the kernel has queued for the device. Returns false if the device is gone.
+static bool gpad__drain_device(Gpad_Device_Entry* entry) {
+    struct input_event events[GPAD__READ_BUFFER_EVENTS];
+
+    for(;;) {
+        const ssize_t size = read(entry->fd, events, sizeof(events));
+        gpad__context.stats.read_calls++;
+        if(size < 0) {
+            if(errno == EINTR) continue;
+            return errno == EAGAIN;
+        }
+        if(size == 0) {
+            return false;
+        }
+
+        gpad__apply_events(entry, events, (int)(size / sizeof(struct input_event)));
+
+        if(size < (ssize_t)sizeof(events)) {
+            return true;
+        }
+    }
+}
+
+// Same as gpad__drain_device, for the joystick API. joydev has no SYN_DROPPED, when its buffer overflows it
+// sends the complete state again as JS_EVENT_INIT events.
+static bool gpad__drain_joystick(Gpad_Device_Entry* entry) {
+    struct js_event events[GPAD__READ_BUFFER_EVENTS];
+
+    for(;;) {
+        const ssize_t size = read(entry->fd, events, sizeof(events));
+        gpad__context.stats.read_calls++;
+        if(size < 0) {
+            if(errno == EINTR) continue;
+            return errno == EAGAIN;
+        }
+        if(size == 0) {
+            return false;
+        }
+
+        const int num_events = (int)(size / sizeof(struct js_event));
+        gpad__context.stats.events_read += num_events;
+        for(int i = 0; i < num_events; i++) {
+            struct input_event event = {0};
+            event.value = events[i].value;
+
+            switch(events[i].type & ~JS_EVENT_INIT) {
+                case JS_EVENT_BUTTON: {
+                    event.type = EV_KEY;
+                    event.code = entry->js_key_codes[events[i].number];
+                } break;
+
+                case JS_EVENT_AXIS: {
+                    if(events[i].number >= ABS_CNT) continue;
+                    event.type = EV_ABS;
+                    event.code = entry->js_abs_codes[events[i].number];
+                } break;
+
+                default: continue;
+            }
+
+            gpad__apply_event(entry, &event);
+        }
+
+        if(size < (ssize_t)sizeof(events)) {
+            return true;
+        }
+    }
+}
+
+// Evaluates the mapping on the raw state and caches the result for gpad_poll_device.
+static void gpad__update_state(Gpad_Device_Entry* entry) {
+    gpad__evaluate_mapping(&entry->mapping, &entry->raw, &entry->state);
+}
+
+// Same as gpad__update_state for every device which got input during this pump.
+static void gpad__update_states(void) {
+    const Gpad_Compiled_Mapping* compiled[GPAD_MAX_DEVICES];
+    const Gpad_Raw_State* raw[GPAD_MAX_DEVICES];
+    Gpad_Device_State* states[GPAD_MAX_DEVICES];
+    bool changed[GPAD_MAX_DEVICES];
+
+    bool any_changed = false;
+    for(int id = 0; id < GPAD_MAX_DEVICES; id++) {
+        Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
+        const bool connected = entry->mapping_index != GPAD_MAPPING_INDEX_INVALID;
+        compiled[id] = connected ? &entry->mapping : NULL;
+        raw[id] = &entry->raw;
+        states[id] = &entry->state;
+        changed[id] = entry->input_changed;
+        any_changed |= entry->input_changed;
+        entry->input_changed = false;
+    }
+    if(!any_changed) return;
+
+    if(gpad__context.axis_batch_dirty) {
+        gpad__build_axis_batch(&gpad__context.axis_batch, compiled, GPAD_MAX_DEVICES);
+        gpad__context.axis_batch_dirty = false;
+    }
+    gpad__evaluate_mappings(&gpad__context.axis_batch, compiled, raw, states, changed, GPAD_MAX_DEVICES);
+}
+
+void gpad__rebind_devices(void) {
+    for(int id = 0; id < GPAD_MAX_DEVICES; id++) {
+        Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
+        if(entry->mapping_index == GPAD_MAPPING_INDEX_INVALID) continue;
+
+        // Devices without a match keep their generic mapping.
+        const int mapping_index = gpad__resolve_mapping(&entry->guid);
+        if(mapping_index >= 0) {
+            entry->mapping_index = (Gpad_Mapping_Index)mapping_index;
+        }
+        // The mapping may also have been replaced in place.
+        gpad__compile_mapping(gpad__get_mapping(entry->mapping_index), entry->axis_calibration, &entry->mapping);
+        gpad__update_state(entry);
+    }
+    gpad__context.axis_batch_dirty = true;
+}
+
+// Whether a /dev/input entry belongs to the active backend.
+static bool gpad__is_device_node(const char* name) {
+    if(gpad__context.backend == Gpad_Backend_Linux_Joystick) {
+        return strncmp(name, "js", 2) == 0;
+    }
+    return strncmp(name, "event", 5) == 0;
+}
+
+static void gpad__disconnect_device(const Gpad_Device_Id id) {
+    gpad__remove_device_entry(id);
+    if(gpad__context.device_callback) {
+        gpad__context.device_callback(id, false, gpad__context.device_callback_user_data);
+    }
+}
+
+// Opens the node if it's a gamepad which isn't open yet.
+static void gpad__connect_device(const char* path) {
+    struct stat st;
+    if(stat(path, &st) < 0 || !S_ISCHR(st.st_mode)) return;
+    if(gpad__device_path_open(path, st.st_rdev)) return;
+
+    const Gpad_Device_Id id = gpad__find_unused_device_id();
+    if(id >= GPAD_MAX_DEVICES) return;
+
+    if(!gpad__open_device(id, path)) {
+        gpad__reset_device_entry(&gpad__context.id_entries[id]);
+        return;
+    }
+
+    if(gpad__context.device_callback) {
+        gpad__context.device_callback(id, true, gpad__context.device_callback_user_data);
+    }
+}
+
+// Adds or removes single devices based on the /dev/input changes since the last call.
+static void gpad__read_hotplug_events(void) {
+    union {
+        struct inotify_event event;
+        char data[4096];
+    } buffer;
+
+    for(;;) {
+        const ssize_t size = read(gpad__context.inotify_fd, &buffer, sizeof(buffer));
+        if(size < 0 && errno == EINTR) continue;
+        if(size <= 0) break;
+
+        for(ssize_t offset = 0; offset < size;) {
+            const struct inotify_event* event = (const struct inotify_event*)&buffer.data[offset];
+            offset += sizeof(struct inotify_event) + event->len;
+
+            if(event->len == 0 || !gpad__is_device_node(event->name)) continue;
+
+            char path[32];
+            if(snprintf(path, sizeof(path), "/dev/input/%s", event->name) >= (int)sizeof(path)) continue;
+
+            if(event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                for(int id = 0; id < GPAD_MAX_DEVICES; id++) {
+                    const Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
+                    if(entry->mapping_index != GPAD_MAPPING_INDEX_INVALID && strcmp(entry->path, path) == 0) {
+                        gpad__disconnect_device(id);
+                    }
+                }
+            } else {
+                gpad__connect_device(path);
+            }
+        }
+    }
+}
+
+#ifdef GPAD_IO_URING
+// Returns false if io_uring is missing, disabled or too old to poll device reads without worker threads.
+static bool gpad__uring_init(void) {
+    Gpad_Uring* uring = &gpad__context.uring;
+    memset(uring, 0, sizeof(Gpad_Uring));
+    uring->fd = -1;
+
+    struct io_uring_params params = {0};
+    const int fd = (int)syscall(__NR_io_uring_setup, GPAD__URING_ENTRIES, &params);
+    if(fd < 0) {
+        return false;
+    }
+    if(!(params.features & IORING_FEAT_FAST_POLL)) {
+        close(fd);
+        return false;
+    }
+
+    uring->fd = fd;
+    uring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    uring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if(single_mmap) {
+        if(uring->cq_ring_size > uring->sq_ring_size) uring->sq_ring_size = uring->cq_ring_size;
+        uring->cq_ring_size = uring->sq_ring_size;
+    }
+
+    const int prot = PROT_READ | PROT_WRITE;
+    const int flags = MAP_SHARED | MAP_POPULATE;
+    uring->sq_ring = mmap(0, uring->sq_ring_size, prot, flags, fd, IORING_OFF_SQ_RING);
+    uring->cq_ring = single_mmap ? uring->sq_ring : mmap(0, uring->cq_ring_size, prot, flags, fd, IORING_OFF_CQ_RING);
+    uring->sqes = (struct io_uring_sqe*)mmap(0, uring->sqes_size, prot, flags, fd, IORING_OFF_SQES);
+
+    if(uring->sq_ring == MAP_FAILED || uring->cq_ring == MAP_FAILED || uring->sqes == MAP_FAILED) {
+        if(uring->sq_ring != MAP_FAILED) munmap(uring->sq_ring, uring->sq_ring_size);
+        if(!single_mmap && uring->cq_ring != MAP_FAILED) munmap(uring->cq_ring, uring->cq_ring_size);
+        if(uring->sqes != MAP_FAILED) munmap(uring->sqes, uring->sqes_size);
+        close(fd);
+        memset(uring, 0, sizeof(Gpad_Uring));
+        uring->fd = -1;
+        return false;
+    }
+
+    uint8_t* sq = (uint8_t*)uring->sq_ring;
+    uring->sq_head = (unsigned int*)(sq + params.sq_off.head);
+    uring->sq_tail = (unsigned int*)(sq + params.sq_off.tail);
+    uring->sq_mask = (unsigned int*)(sq + params.sq_off.ring_mask);
+    uring->sq_array = (unsigned int*)(sq + params.sq_off.array);
+
+    uint8_t* cq = (uint8_t*)uring->cq_ring;
+    uring->cq_head = (unsigned int*)(cq + params.cq_off.head);
+    uring->cq_tail = (unsigned int*)(cq + params.cq_off.tail);
+    uring->cq_mask = (unsigned int*)(cq + params.cq_off.ring_mask);
+    uring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    // SQE slots are used in order, so the indirection array is the identity.
+    for(unsigned int i = 0; i < params.sq_entries; i++) {
+        uring->sq_array[i] = i;
+    }
+
+    return true;
+}
+
+static void gpad__uring_shutdown(void) {
+    Gpad_Uring* uring = &gpad__context.uring;
+    if(uring->fd < 0) return;
+
+    // Closing the ring cancels all reads still in flight.
+    munmap(uring->sqes, uring->sqes_size);
+    if(uring->cq_ring != uring->sq_ring) munmap(uring->cq_ring, uring->cq_ring_size);
+    munmap(uring->sq_ring, uring->sq_ring_size);
+    close(uring->fd);
+
+    memset(uring, 0, sizeof(Gpad_Uring));
+    uring->fd = -1;
+}
+
+// Passes the queued submissions to the kernel, and reaps nothing unless flags has IORING_ENTER_GETEVENTS.
+static void gpad__uring_submit(const unsigned int flags) {
+    Gpad_Uring* uring = &gpad__context.uring;
+    const int submitted = (int)syscall(__NR_io_uring_enter, uring->fd, uring->to_submit, 0, flags, 0, 0);
+    if(submitted > 0) {
+        uring->to_submit -= (unsigned int)submitted;
+    }
+}
+
+// Queued until the next gpad_pump. If the ring is full it's submitted right away to make room,
+// returns 0 only if that fails too.
+static struct io_uring_sqe* gpad__uring_get_sqe(void) {
+    Gpad_Uring* uring = &gpad__context.uring;
+    unsigned int head = __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+    const unsigned int tail = *uring->sq_tail;
+    if(tail - head > *uring->sq_mask) {
+        gpad__uring_submit(0);
+        head = __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+        if(tail - head > *uring->sq_mask) return 0;
+    }
+
+    struct io_uring_sqe* sqe = &uring->sqes[tail & *uring->sq_mask];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    __atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    uring->to_submit++;
+    return sqe;
+}
+
+static uint64_t gpad__uring_read_user_data(const Gpad_Device_Id id) {
+    return ((uint64_t)gpad__context.uring.slots[id].generation << 8) | id;
+}
+
+static void gpad__uring_arm_read(const Gpad_Device_Id id) {
+    Gpad_Uring_Slot* slot = &gpad__context.uring.slots[id];
+    // Re-armed when the previous read completes.
+    if(slot->in_flight) return;
+
+    struct io_uring_sqe* sqe = gpad__uring_get_sqe();
+    if(!sqe) {
+        gpad__context.uring.rearm = true;
+        return;
+    }
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = gpad__context.id_entries[id].fd;
+    sqe->addr = (uint64_t)(uintptr_t)&slot->events[0];
+    sqe->len = sizeof(slot->events);
+    sqe->user_data = gpad__uring_read_user_data(id);
+    slot->in_flight = true;
+}
+
+static void gpad__uring_cancel_read(const Gpad_Device_Id id) {
+    if(!gpad__context.uring.slots[id].in_flight) return;
+
+    struct io_uring_sqe* sqe = gpad__uring_get_sqe();
+    if(!sqe) return;
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = gpad__uring_read_user_data(id);
+    sqe->user_data = GPAD__URING_CANCEL;
+}
+
+static void gpad__uring_arm_hotplug(void) {
+    if(gpad__context.inotify_fd < 0) return;
+
+    struct io_uring_sqe* sqe = gpad__uring_get_sqe();
+    if(!sqe) return;
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = gpad__context.inotify_fd;
+    sqe->poll_events = POLLIN;
+    sqe->user_data = GPAD__URING_HOTPLUG;
+}
+
+static void gpad__uring_complete_read(const Gpad_Device_Id id, const uint32_t generation, const int32_t result) {
+    Gpad_Uring_Slot* slot = &gpad__context.uring.slots[id];
+    Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
+    slot->in_flight = false;
+
+    if(generation != slot->generation || entry->fd < 0) {
+        // The device was removed. If a new one took the slot, its first read waited for the buffer.
+        if(entry->fd >= 0) {
+            gpad__uring_arm_read(id);
+        }
+        return;
+    }
+
+    if(result == -EINTR || result == -EAGAIN) {
+        gpad__uring_arm_read(id);
+        return;
+    }
+
+    if(result <= 0) {
+        gpad__disconnect_device(id);
+        return;
+    }
+
+    gpad__context.stats.read_calls++;
+    gpad__apply_events(entry, slot->events, result / (int)sizeof(struct input_event));
+    entry->input_changed = true;
+    gpad__uring_arm_read(id);
+}
+
+// Submits everything queued since the last pump and reaps all completions with a single io_uring_enter.
+static void gpad__uring_pump(void) {
+    Gpad_Uring* uring = &gpad__context.uring;
+    gpad__uring_submit(IORING_ENTER_GETEVENTS);
+
+    unsigned int head = *uring->cq_head;
+    const unsigned int tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+
+    for(; head != tail; head++) {
+        const struct io_uring_cqe cqe = uring->cqes[head & *uring->cq_mask];
+
+        if(cqe.user_data == GPAD__URING_HOTPLUG) {
+            gpad__read_hotplug_events();
+            gpad__uring_arm_hotplug();
+        } else if(cqe.user_data != GPAD__URING_CANCEL) {
+            const Gpad_Device_Id id = (Gpad_Device_Id)(cqe.user_data & 0xff);
+            if(id < GPAD_MAX_DEVICES) {
+                gpad__uring_complete_read(id, (uint32_t)(cqe.user_data >> 8), cqe.res);
+            }
+        }
+    }
+
+    __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+
+    // Queued for the next pump.
+    if(uring->rearm) {
+        uring->rearm = false;
+        for(int id = 0; id < GPAD_MAX_DEVICES; id++) {
+            if(gpad__context.id_entries[id].fd >= 0) gpad__uring_arm_read((Gpad_Device_Id)id);
+        }
+    }
+}
+#endif // GPAD_IO_URING
+
+bool gpad_initialize(void) {
+    return gpad_initialize_backend(Gpad_Backend_Default);
+}
+
+bool gpad_initialize_backend(Gpad_Backend backend) {
+    if(gpad__context.initialized) return false;
+
+    switch(backend) {
+        case Gpad_Backend_Default:
+        case Gpad_Backend_Linux_Evdev: gpad__context.backend = Gpad_Backend_Linux_Evdev; break;
+        case Gpad_Backend_Linux_Joystick: gpad__context.backend = Gpad_Backend_Linux_Joystick; break;
+        default: return false;
+    }
+
+    for(int id = 0; id < GPAD_MAX_DEVICES; id++) {
+        gpad__reset_device_entry(&gpad__context.id_entries[id]);
+    }
+
+    gpad__context.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(gpad__context.epoll_fd < 0) {
+        return false;
+    }
+
+    // Hotplug is optional, without it devices are only found by gpad_refresh_connected_devices.
+    // IN_ATTRIB is needed because udev usually fixes up the node permissions only after it's created.
+    gpad__context.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(gpad__context.inotify_fd >= 0) {
+        const uint32_t mask = IN_CREATE | IN_ATTRIB | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM;
+        struct epoll_event epoll_event = {0};
+        epoll_event.events = EPOLLIN;
+        epoll_event.data.u32 = GPAD__EPOLL_HOTPLUG;
+        if(inotify_add_watch(gpad__context.inotify_fd, "/dev/input", mask) < 0 ||
+           epoll_ctl(gpad__context.epoll_fd, EPOLL_CTL_ADD, gpad__context.inotify_fd, &epoll_event) < 0) {
+            close(gpad__context.inotify_fd);
+            gpad__context.inotify_fd = -1;
+        }
+    }
+
+#ifdef GPAD_IO_URING
+    // The joystick API is only read through epoll.
+    gpad__context.use_uring = gpad__context.backend == Gpad_Backend_Linux_Evdev && gpad__uring_init();
+    if(gpad__context.use_uring) {
+        gpad__uring_arm_hotplug();
+    }
+#endif
+
+    gpad__load_env_mappings();
+
+    gpad__context.initialized = true;
+
+    gpad_refresh_connected_devices();
+
+    return true;
+}
+
+void gpad_shutdown(void) {
+    if(!gpad__context.initialized) return;
+
+    for(int id = 0; id < GPAD_MAX_DEVICES; id++) {
+        gpad__remove_device_entry(id);
+    }
+
+    if(gpad__context.inotify_fd >= 0) {
+        close(gpad__context.inotify_fd);
+        gpad__context.inotify_fd = -1;
+    }
+
+#ifdef GPAD_IO_URING
+    if(gpad__context.use_uring) {
+        gpad__uring_shutdown();
+        gpad__context.use_uring = false;
+    }
+#endif
+
+    close(gpad__context.epoll_fd);
+    gpad__context.epoll_fd = -1;
+
+    gpad__context.initialized = false;
+}
+
+void gpad_set_device_callback(Gpad_Device_Callback callback, void* user_data) {
+    gpad__context.device_callback = callback;
+    gpad__context.device_callback_user_data = user_data;
+}
+
+bool gpad_is_initialized(void) {
+    return gpad__context.initialized;
+}
+
+bool gpad_device_valid(Gpad_Device_Id id) {
+    if(!gpad__context.initialized) return false;
+    if(id >= GPAD_MAX_DEVICES) return false;
+    return gpad__context.id_entries[id].mapping_index < GPAD__NUM_MAPPINGS;
+}
+
+void gpad_refresh_connected_devices(void) {
+    if(!gpad__context.initialized) return;
+
+    // Drop devices whose node disappeared. Devices which are still connected keep their ID and fd.
+    for(int id = 0; id < GPAD_MAX_DEVICES; id++) {
+        const Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
+        if(entry->mapping_index == GPAD_MAPPING_INDEX_INVALID) continue;
+
+        struct stat st;
+        if(stat(entry->path, &st) < 0 || st.st_rdev != entry->rdev) {
+            gpad__disconnect_device(id);
+        }
+    }
+
+    DIR* dir = opendir("/dev/input");
+    if(!dir) return;
+
+    struct dirent* dirent;
+    while((dirent = readdir(dir)) != 0) {
+        if(!gpad__is_device_node(dirent->d_name)) continue;
+
+        if(gpad__find_unused_device_id() >= GPAD_MAX_DEVICES) break;
+
+        char path[32];
+        if(snprintf(path, sizeof(path), "/dev/input/%s", dirent->d_name) >= (int)sizeof(path)) continue;
+
+        gpad__connect_device(path);
+    }
+
+    closedir(dir);
+}
+
+void gpad_pump(void) {
+    if(!gpad__context.initialized) return;
+
+#ifdef GPAD_IO_URING
+    if(gpad__context.use_uring) {
+        gpad__uring_pump();
+        gpad__update_states();
+        return;
+    }
+#endif
+
+    struct epoll_event events[GPAD_MAX_DEVICES + 1];
+    const int num_events = epoll_wait(gpad__context.epoll_fd, events, GPAD_MAX_DEVICES + 1, 0);
+
+    for(int i = 0; i < num_events; i++) {
+        if(events[i].data.u32 == GPAD__EPOLL_HOTPLUG) {
+            gpad__read_hotplug_events();
+            continue;
+        }
+
+        const Gpad_Device_Id id = (Gpad_Device_Id)events[i].data.u32;
+        if(id >= GPAD_MAX_DEVICES) continue;
+
+        Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
+        if(entry->fd < 0) continue;
+
+        // Pending input is read first, a device can report its last events together with the hangup.
+        const bool drained =
+            entry->kind == Gpad_Device_Entry_Kind_Joystick ? gpad__drain_joystick(entry) : gpad__drain_device(entry);
+        if(!drained || (events[i].events & (EPOLLHUP | EPOLLERR))) {
+            gpad__disconnect_device(id);
+            continue;
+        }
+
+        entry->input_changed = true;
+    }
+
+    gpad__update_states();
+}
+
+void gpad_get_stats(Gpad_Stats* out_stats) {
+    if(out_stats) {
+        *out_stats = gpad__context.stats;
+    }
+}
+
+int gpad_list_devices(Gpad_Device_Id* ids, const int ids_max) {
+    if(!gpad__context.initialized) return 0;
+    int num = 0;
+    for(int id = 0; id < GPAD_MAX_DEVICES; id++) {
+        if(gpad__context.id_entries[id].mapping_index < GPAD__NUM_MAPPINGS) {
+            if(num >= ids_max) {
+                break;
+            }
+            ids[num] = id;
+            num++;
+        }
+    }
+    return num;
+}
+
+bool gpad_poll_device(const Gpad_Device_Id id, Gpad_Device_State* out_state) {
+    if(!gpad__context.initialized) return false;
+    if(out_state == 0) return false;
+    if(id >= GPAD_MAX_DEVICES) return false;
+
+    const Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
+
+    if(entry->mapping_index >= GPAD__NUM_MAPPINGS) return false;
+
+    *out_state = entry->state;
+    return true;
+}
+
+bool gpad_rumble_device(const Gpad_Device_Id id, float low_frequency, float high_frequency) {
+    if(!gpad__context.initialized) return false;
+    if(id >= GPAD_MAX_DEVICES) return false;
+
+    Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
+
+    if(entry->mapping_index >= GPAD__NUM_MAPPINGS) return false;
+
+    // Clamp the inputs
+    if(low_frequency < 0.0f) low_frequency = 0.0f;
+    if(low_frequency > 1.0f) low_frequency = 1.0f;
+    if(high_frequency < 0.0f) high_frequency = 0.0f;
+    if(high_frequency > 1.0f) high_frequency = 1.0f;
+
+    if(!entry->has_rumble) return false;
+
+    const uint16_t strong = (uint16_t)(low_frequency * 65535.0f);
+    const uint16_t weak = (uint16_t)(high_frequency * 65535.0f);
+
+    // Games usually call this every frame, only talk to the device when something changed.
+    if(entry->ff_effect_id >= 0 && strong == entry->rumble_strong && weak == entry->rumble_weak) {
+        return true;
+    }
+
+    const bool play = strong != 0 || weak != 0;
+
+    // Updating an uploaded effect which is already playing takes effect immediately, no need to replay it.
+    if(play) {
+        // Zero length plays the effect until it's changed, same as XInput.
+        struct ff_effect effect = {0};
+        effect.type = FF_RUMBLE;
+        effect.id = entry->ff_effect_id;
+        effect.u.rumble.strong_magnitude = strong;
+        effect.u.rumble.weak_magnitude = weak;
+
+        // Fails with EBADF if the device was opened read-only.
+        if(ioctl(entry->fd, EVIOCSFF, &effect) < 0) {
+            return false;
+        }
+        entry->ff_effect_id = effect.id;
+    }
+
+    if(play != entry->rumble_playing && entry->ff_effect_id >= 0) {
+        struct input_event event = {0};
+        event.type = EV_FF;
+        event.code = (uint16_t)entry->ff_effect_id;
+        event.value = play ? 1 : 0;
+
+        if(write(entry->fd, &event, sizeof(event)) != (ssize_t)sizeof(event)) {
+            return false;
+        }
+        entry->rumble_playing = play;
+    }
+
+    entry->rumble_strong = strong;
+    entry->rumble_weak = weak;
+    return true;
+}
+#endif // __linux__
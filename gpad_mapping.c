@@ -0,0 +1,1184 @@
+#if defined(_WIN32)
+#define GPAD_PLATFORM_WINDOWS
+#elif defined(__linux__)
+#define GPAD_PLATFORM_LINUX
+#elif defined(__APPLE__)
+#define GPAD_PLATFORM_MAC
+#endif
+
+#include "gpad.h"
+#include "gpad_mapping.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef GPAD_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Generated by build_db. GPAD_DATABASE_INL selects another one, like the build_db --compress output of the tests.
+#ifdef GPAD_DATABASE_INL
+#include GPAD_DATABASE_INL
+#else
+#include "gpad_gamecontrollerdb.inl"
+#endif
+
+#if !defined(GPAD_NO_SIMD) && defined(__AVX2__)
+#define GPAD__AVX2
+#include <immintrin.h>
+#elif !defined(GPAD_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define GPAD__SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(GPAD_PLATFORM_WINDOWS)
+#define GPAD__PLATFORM_NAME "Windows"
+#elif defined(GPAD_PLATFORM_LINUX)
+#define GPAD__PLATFORM_NAME "Linux"
+#elif defined(GPAD_PLATFORM_MAC)
+#define GPAD__PLATFORM_NAME "Mac OS X"
+#endif
+
+#define GPAD__ARRAY_COUNT(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+// Everything the lookups need. Points either to the built-in tables or into a mapped database file.
+typedef struct Gpad_Database {
+    const Gpad_Guid* guids;
+    const Gpad_Mapping_Row* rows;
+    const Gpad_Mapping* pool;
+    const uint16_t* displacements;
+    const uint16_t* slots;
+    const char* names;
+    // Second perfect hash over gpad__guid_key, for devices with a version or CRC the database doesn't have.
+    const uint16_t* key_displacements;
+    const uint16_t* key_slots;
+    uint32_t num_rows;
+    uint32_t num_buckets; // Power of two
+    uint32_t num_slots; // Power of two
+    uint32_t num_key_buckets; // Power of two
+    uint32_t num_key_slots; // Power of two
+} Gpad_Database;
+
+static Gpad_Database g_gpad_database = {
+    g_gpad_mapping_guids,
+    g_gpad_mappings,
+#ifdef GPAD__COMPRESSED_POOL_SIZE
+    NULL, // Decoded on demand, see gpad__get_mapping
+#else
+    g_gpad_mapping_pool,
+#endif
+    g_gpad_mapping_hash_displacements,
+    g_gpad_mapping_hash_slots,
+    g_gpad_mapping_names,
+    g_gpad_mapping_key_displacements,
+    g_gpad_mapping_key_slots,
+    GPAD__ARRAY_COUNT(g_gpad_mappings),
+    GPAD__ARRAY_COUNT(g_gpad_mapping_hash_displacements),
+    GPAD__ARRAY_COUNT(g_gpad_mapping_hash_slots),
+    GPAD__ARRAY_COUNT(g_gpad_mapping_key_displacements),
+    GPAD__ARRAY_COUNT(g_gpad_mapping_key_slots),
+};
+
+// The mapped file backing g_gpad_database, if any.
+static const void* g_gpad_database_file;
+static size_t g_gpad_database_file_size;
+
+#define GPAD__NUM_DATABASE_MAPPINGS ((int)g_gpad_database.num_rows)
+// Longer names are truncated.
+#define GPAD__RUNTIME_NAME_SIZE 64
+// At most half full, so probing always ends on an empty slot.
+#define GPAD__RUNTIME_TABLE_SIZE (GPAD_MAX_RUNTIME_MAPPINGS * 2)
+
+// Mappings loaded with gpad_load_mappings_*. Their mapping indices start after the database.
+// Everything is preallocated, loading never allocates.
+typedef struct Gpad_Runtime_Mappings {
+    int count;
+    Gpad_Guid guids[GPAD_MAX_RUNTIME_MAPPINGS];
+    Gpad_Mapping mappings[GPAD_MAX_RUNTIME_MAPPINGS];
+    char names[GPAD_MAX_RUNTIME_MAPPINGS][GPAD__RUNTIME_NAME_SIZE];
+    // Made up by a backend with gpad__add_generic_mapping. Lookups skip them, so any real mapping
+    // which turns up later takes over on the next rebind.
+    bool generic[GPAD_MAX_RUNTIME_MAPPINGS];
+    // Index + 1, zero is an empty slot.
+    uint16_t table[GPAD__RUNTIME_TABLE_SIZE];
+    // Same over gpad__guid_key, the last loaded mapping for a key wins.
+    uint16_t key_table[GPAD__RUNTIME_TABLE_SIZE];
+} Gpad_Runtime_Mappings;
+
+static Gpad_Runtime_Mappings g_gpad_runtime_mappings;
+
+typedef struct Gpad_Sdl_Field {
+    const char* name;
+    uint8_t len;
+    bool axis;
+    uint8_t index; // Gpad_Button or Gpad_Axis
+} Gpad_Sdl_Field;
+
+#define GPAD__SDL_BUTTON(name, button) {name, sizeof(name) - 1, false, Gpad_Button_##button}
+#define GPAD__SDL_AXIS(name, axis) {name, sizeof(name) - 1, true, Gpad_Axis_##axis}
+
+static const Gpad_Sdl_Field g_gpad_sdl_fields[] = {
+    GPAD__SDL_BUTTON("a", A),
+    GPAD__SDL_BUTTON("b", B),
+    GPAD__SDL_BUTTON("x", X),
+    GPAD__SDL_BUTTON("y", Y),
+    GPAD__SDL_BUTTON("leftshoulder", Left_Shoulder),
+    GPAD__SDL_BUTTON("rightshoulder", Right_Shoulder),
+    GPAD__SDL_BUTTON("back", Back),
+    GPAD__SDL_BUTTON("start", Start),
+    GPAD__SDL_BUTTON("guide", Guide),
+    GPAD__SDL_BUTTON("leftstick", Left_Thumb),
+    GPAD__SDL_BUTTON("rightstick", Right_Thumb),
+    GPAD__SDL_BUTTON("dpup", Dpad_Up),
+    GPAD__SDL_BUTTON("dpright", Dpad_Right),
+    GPAD__SDL_BUTTON("dpdown", Dpad_Down),
+    GPAD__SDL_BUTTON("dpleft", Dpad_Left),
+    GPAD__SDL_AXIS("leftx", Left_X),
+    GPAD__SDL_AXIS("lefty", Left_Y),
+    GPAD__SDL_AXIS("rightx", Right_X),
+    GPAD__SDL_AXIS("righty", Right_Y),
+    GPAD__SDL_AXIS("lefttrigger", Left_Trigger),
+    GPAD__SDL_AXIS("righttrigger", Right_Trigger),
+};
+
+// Perfect hash of the field names above, over the first and last character and the length.
+#define GPAD__SDL_FIELD_HASH(first, last, len) (((first) * 5 + (last) + (len) * 2) & 63)
+
+// g_gpad_sdl_fields index + 1 by GPAD__SDL_FIELD_HASH, zero is an empty slot. Filled by the first parse.
+static uint8_t g_gpad_sdl_field_table[64];
+
+bool gpad_device_button_pressed(const Gpad_Device_State* state, const Gpad_Button button) {
+    if(state && button < Gpad_Button_COUNT) {
+        return state->buttons & (1 << button);
+    }
+    return false;
+}
+
+const char* gpad_button_name(Gpad_Button button) {
+    switch(button) {
+        case Gpad_Button_A: return "A";
+        case Gpad_Button_B: return "B";
+        case Gpad_Button_X: return "X";
+        case Gpad_Button_Y: return "Y";
+        case Gpad_Button_Left_Shoulder: return "Left_Shoulder";
+        case Gpad_Button_Right_Shoulder: return "Right_Shoulder";
+        case Gpad_Button_Back: return "Back";
+        case Gpad_Button_Start: return "Start";
+        case Gpad_Button_Guide: return "Guide";
+        case Gpad_Button_Left_Thumb: return "Left_Thumb";
+        case Gpad_Button_Right_Thumb: return "Right_Thumb";
+        case Gpad_Button_Dpad_Up: return "Dpad_Up";
+        case Gpad_Button_Dpad_Right: return "Dpad_Right";
+        case Gpad_Button_Dpad_Down: return "Dpad_Down";
+        case Gpad_Button_Dpad_Left: return "Dpad_Left";
+    }
+    return "<Invalid>";
+}
+
+const char* gpad_axis_name(Gpad_Axis axis) {
+    switch(axis) {
+        case Gpad_Axis_Left_X: return "Left_X";
+        case Gpad_Axis_Left_Y: return "Left_Y";
+        case Gpad_Axis_Right_X: return "Right_X";
+        case Gpad_Axis_Right_Y: return "Right_Y";
+        case Gpad_Axis_Left_Trigger: return "Left_Trigger";
+        case Gpad_Axis_Right_Trigger: return "Right_Trigger";
+    }
+    return "<Invalid>";
+}
+
+int gpad__mapping_count(void) {
+    return GPAD__NUM_DATABASE_MAPPINGS + g_gpad_runtime_mappings.count;
+}
+
+static int gpad__hex_digit(const char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Returns the slot holding the GUID, or the empty slot where it belongs.
+static uint16_t* gpad__runtime_slot(const Gpad_Guid* guid) {
+    uint32_t slot = gpad__guid_hash(guid, 0) % GPAD__RUNTIME_TABLE_SIZE;
+    for(;;) {
+        uint16_t* value = &g_gpad_runtime_mappings.table[slot];
+        if(*value == 0 || gpad__guid_equal(&g_gpad_runtime_mappings.guids[*value - 1], guid)) {
+            return value;
+        }
+        slot = (slot + 1) % GPAD__RUNTIME_TABLE_SIZE;
+    }
+}
+
+// Same for the key table, the key must come from gpad__guid_key.
+static uint16_t* gpad__runtime_key_slot(const Gpad_Guid* key) {
+    uint32_t slot = gpad__guid_hash(key, 0) % GPAD__RUNTIME_TABLE_SIZE;
+    for(;;) {
+        uint16_t* value = &g_gpad_runtime_mappings.key_table[slot];
+        Gpad_Guid other;
+        if(*value == 0 || (gpad__guid_key(&g_gpad_runtime_mappings.guids[*value - 1], &other) &&
+                              gpad__guid_equal(&other, key))) {
+            return value;
+        }
+        slot = (slot + 1) % GPAD__RUNTIME_TABLE_SIZE;
+    }
+}
+
+// Returns -1 on failure.
+// Runtime mappings take precedence over the database.
+// The database has a perfect hash over its GUIDs: the unseeded hash picks a bucket, the bucket's seed picks the slot.
+// Only the slot's row still has to be compared, so this touches a few cache lines regardless of the table size.
+int gpad__find_mapping(const Gpad_Guid* guid) {
+    if(g_gpad_runtime_mappings.count > 0) {
+        const uint16_t value = *gpad__runtime_slot(guid);
+        if(value != 0 && !g_gpad_runtime_mappings.generic[value - 1]) {
+            return GPAD__NUM_DATABASE_MAPPINGS + value - 1;
+        }
+    }
+
+    const Gpad_Database* db = &g_gpad_database;
+    const uint16_t seed = db->displacements[gpad__guid_hash(guid, 0) & (db->num_buckets - 1)];
+    const uint16_t index = db->slots[gpad__guid_hash(guid, seed) & (db->num_slots - 1)];
+    if(index >= db->num_rows || !gpad__guid_equal(&db->guids[index], guid)) {
+        return -1;
+    }
+    return index;
+}
+
+// SDL style fallbacks, see gpad__resolve_mapping. Each step is one probe into the runtime table and one into the
+// database, so an unknown device costs a handful of probes instead of a scan.
+int gpad__resolve_mapping(const Gpad_Guid* guid) {
+    int result = gpad__find_mapping(guid);
+    if(result >= 0) return result;
+
+    // CRC of the name, bytes 2 and 3. Most database rows have none, but keep the version.
+    Gpad_Guid fallback = *guid;
+    fallback.data[2] = 0;
+    fallback.data[3] = 0;
+    result = gpad__find_mapping(&fallback);
+    if(result >= 0) return result;
+
+    // Version, bytes 12 and 13.
+    fallback = *guid;
+    fallback.data[12] = 0;
+    fallback.data[13] = 0;
+    result = gpad__find_mapping(&fallback);
+    if(result >= 0) return result;
+
+    // Both.
+    fallback.data[2] = 0;
+    fallback.data[3] = 0;
+    result = gpad__find_mapping(&fallback);
+    if(result >= 0) return result;
+
+    Gpad_Guid key;
+    if(!gpad__guid_key(guid, &key)) return -1;
+
+    if(g_gpad_runtime_mappings.count > 0) {
+        const uint16_t value = *gpad__runtime_key_slot(&key);
+        if(value != 0) {
+            return GPAD__NUM_DATABASE_MAPPINGS + value - 1;
+        }
+    }
+
+    const Gpad_Database* db = &g_gpad_database;
+    const uint16_t seed = db->key_displacements[gpad__guid_hash(&key, 0) & (db->num_key_buckets - 1)];
+    const uint16_t index = db->key_slots[gpad__guid_hash(&key, seed) & (db->num_key_slots - 1)];
+    if(index >= db->num_rows || !gpad__guid_key(&db->guids[index], &fallback) || !gpad__guid_equal(&fallback, &key)) {
+        return -1;
+    }
+    return index;
+}
+
+#ifdef GPAD__COMPRESSED_POOL_SIZE
+// build_db --compress, the pool is stored in LZ compressed blocks and mappings are decoded when first used.
+// Only the few mappings of connected devices are ever needed, so they are kept in a small cache.
+typedef struct Gpad_Decoded_Mappings {
+    Gpad_Mapping mappings[GPAD_MAX_DECODED_MAPPINGS];
+    uint16_t pool_indices[GPAD_MAX_DECODED_MAPPINGS];
+    uint8_t cache_slots[GPAD__COMPRESSED_POOL_SIZE]; // Cache slot + 1 of each pool entry, 0 if not decoded
+    uint8_t next_slot; // Replaced next, round robin
+} Gpad_Decoded_Mappings;
+
+#if GPAD_MAX_DECODED_MAPPINGS < 1 || GPAD_MAX_DECODED_MAPPINGS > 255
+#error "GPAD_MAX_DECODED_MAPPINGS must be between 1 and 255"
+#endif
+
+static Gpad_Decoded_Mappings g_gpad_decoded_mappings;
+
+// Format is described in build_db. Returns false on corrupt data.
+static bool gpad__lz_decode(const uint8_t* src, const uint8_t* src_end, uint8_t* dst, const size_t dst_size) {
+    size_t pos = 0;
+    while(src < src_end) {
+        const uint8_t token = *src++;
+
+        size_t num_literals = token >> 4;
+        if(num_literals == 15) {
+            uint8_t byte;
+            do {
+                if(src >= src_end) return false;
+                byte = *src++;
+                num_literals += byte;
+            } while(byte == 255);
+        }
+        if(num_literals > (size_t)(src_end - src) || num_literals > dst_size - pos) return false;
+        memcpy(dst + pos, src, num_literals);
+        src += num_literals;
+        pos += num_literals;
+
+        // The last sequence has no match.
+        if(src == src_end) break;
+
+        if(src_end - src < 2) return false;
+        const size_t offset = (size_t)src[0] | (size_t)src[1] << 8;
+        src += 2;
+        size_t length = (token & 15) + 4;
+        if(length == 15 + 4) {
+            uint8_t byte;
+            do {
+                if(src >= src_end) return false;
+                byte = *src++;
+                length += byte;
+            } while(byte == 255);
+        }
+        if(offset == 0 || offset > pos || length > dst_size - pos) return false;
+        // Byte by byte, matches can overlap what they copy.
+        for(size_t i = 0; i < length; i++, pos++) {
+            dst[pos] = dst[pos - offset];
+        }
+    }
+    return pos == dst_size;
+}
+
+static const Gpad_Mapping* gpad__decode_mapping(const uint16_t pool_index) {
+    Gpad_Decoded_Mappings* decoded = &g_gpad_decoded_mappings;
+    if(decoded->cache_slots[pool_index]) {
+        return &decoded->mappings[decoded->cache_slots[pool_index] - 1];
+    }
+
+    const int block = pool_index / GPAD__COMPRESSED_POOL_BLOCK_SIZE;
+    const int first = block * GPAD__COMPRESSED_POOL_BLOCK_SIZE;
+    int count = GPAD__COMPRESSED_POOL_SIZE - first;
+    if(count > GPAD__COMPRESSED_POOL_BLOCK_SIZE) count = GPAD__COMPRESSED_POOL_BLOCK_SIZE;
+
+    Gpad_Mapping block_mappings[GPAD__COMPRESSED_POOL_BLOCK_SIZE];
+    const bool valid = gpad__lz_decode(
+        &g_gpad_mapping_pool_compressed[g_gpad_mapping_pool_blocks[block]],
+        &g_gpad_mapping_pool_compressed[g_gpad_mapping_pool_blocks[block + 1]],
+        (uint8_t*)block_mappings,
+        count * sizeof(Gpad_Mapping));
+
+    const int slot = decoded->next_slot;
+    decoded->next_slot = (uint8_t)((slot + 1) % GPAD_MAX_DECODED_MAPPINGS);
+    if(decoded->cache_slots[decoded->pool_indices[slot]] == slot + 1) {
+        decoded->cache_slots[decoded->pool_indices[slot]] = 0;
+    }
+    // Generated by build_db, so this can only fail if the .inl was edited by hand. Maps nothing then.
+    if(valid) {
+        decoded->mappings[slot] = block_mappings[pool_index - first];
+    } else {
+        memset(&decoded->mappings[slot], 0, sizeof(Gpad_Mapping));
+    }
+    decoded->pool_indices[slot] = pool_index;
+    decoded->cache_slots[pool_index] = (uint8_t)(slot + 1);
+    return &decoded->mappings[slot];
+}
+#endif
+
+const Gpad_Mapping* gpad__get_mapping(Gpad_Mapping_Index index) {
+    if(index >= GPAD__NUM_DATABASE_MAPPINGS) {
+        return &g_gpad_runtime_mappings.mappings[index - GPAD__NUM_DATABASE_MAPPINGS];
+    }
+    const uint16_t pool_index = g_gpad_database.rows[index].pool_index;
+#ifdef GPAD__COMPRESSED_POOL_SIZE
+    // Unless a database file was loaded, those are used in place.
+    if(!g_gpad_database.pool) return gpad__decode_mapping(pool_index);
+#endif
+    return &g_gpad_database.pool[pool_index];
+}
+
+const char* gpad__mapping_name(Gpad_Mapping_Index index) {
+    if(index >= GPAD__NUM_DATABASE_MAPPINGS) {
+        return &g_gpad_runtime_mappings.names[index - GPAD__NUM_DATABASE_MAPPINGS][0];
+    }
+    return &g_gpad_database.names[g_gpad_database.rows[index].name_offset];
+}
+
+const char* gpad__mapping_kind_name(Gpad_Mapping_Kind kind) {
+    switch(kind) {
+        case Gpad_Mapping_Kind_Axis: return "Axis";
+        case Gpad_Mapping_Kind_Button: return "Button";
+        case Gpad_Mapping_Kind_Hatbit: return "Hatbit";
+    }
+    return "<Invalid>";
+}
+
+//
+// Evaluation
+//
+
+// Group of the op for an element, Gpad_Mapping_Op_Group_COUNT if it's unmapped or can never be active.
+static Gpad_Mapping_Op_Group gpad__mapping_op_group(const Gpad_Mapping_Elem elem, const bool axis_output, const bool half) {
+    switch(elem.kind) {
+        case Gpad_Mapping_Kind_Button: {
+            if(elem.index >= GPAD__MAX_RAW_BUTTONS) break;
+            if(half) return Gpad_Mapping_Op_Group_Button_To_Half_Axis;
+            return axis_output ? Gpad_Mapping_Op_Group_Button_To_Axis : Gpad_Mapping_Op_Group_Button_To_Button;
+        }
+
+        case Gpad_Mapping_Kind_Hatbit: {
+            if((elem.index >> 4) >= GPAD__MAX_RAW_HATS || (elem.index & 0xf) == 0) break;
+            if(half) return Gpad_Mapping_Op_Group_Hat_To_Half_Axis;
+            // Buttons are in Gpad_Compiled_Mapping.hat_buttons instead.
+            if(axis_output) return Gpad_Mapping_Op_Group_Hat_To_Axis;
+        } break;
+
+        case Gpad_Mapping_Kind_Axis: {
+            // Unmapped elements are all zero.
+            if(elem.axis_scale == 0) break;
+            if(elem.index >= GPAD__MAX_RAW_AXES) break;
+            if(half) return Gpad_Mapping_Op_Group_Axis_To_Half_Axis;
+            return axis_output ? Gpad_Mapping_Op_Group_Axis_To_Axis : Gpad_Mapping_Op_Group_Axis_To_Button;
+        }
+    }
+    return Gpad_Mapping_Op_Group_COUNT;
+}
+
+// Where an axis element starts and ends in normalized units, SDL interpolates the output from 0 at from to 1 at to.
+static void gpad__axis_input_range(const Gpad_Mapping_Elem elem, double* out_from, double* out_to) {
+    // The element maps the range to [-1, 1], so invert that.
+    double from = (-1.0 - elem.axis_offset) / elem.axis_scale;
+    double to = (1.0 - elem.axis_offset) / elem.axis_scale;
+    // Except that SDL counts negative half axes like "-a0" from the center outwards.
+    if(from + to < 0.0) {
+        const double temp = from;
+        from = to;
+        to = temp;
+    }
+    *out_from = from;
+    *out_to = to;
+}
+
+static void gpad__compile_elem(
+    Gpad_Compiled_Mapping* compiled,
+    int* num_ops,
+    const Gpad_Mapping_Op_Group group,
+    const Gpad_Mapping_Elem elem,
+    const Gpad_Axis_Calibration* calibration,
+    const int output,
+    const bool axis_output,
+    const bool half,
+    const float output_from,
+    const float output_to) {
+    if(gpad__mapping_op_group(elem, axis_output, half) != group) return;
+
+    Gpad_Mapping_Op* op = &compiled->ops[(*num_ops)++];
+    op->output = (uint8_t)output;
+    if(elem.kind == Gpad_Mapping_Kind_Hatbit) {
+        op->input = elem.index >> 4;
+        op->hat_bits = elem.index & 0xf;
+    } else {
+        op->input = elem.index;
+    }
+
+    switch(group) {
+        case Gpad_Mapping_Op_Group_Button_To_Half_Axis:
+        case Gpad_Mapping_Op_Group_Hat_To_Half_Axis: {
+            op->scale = output_to;
+        } break;
+
+        case Gpad_Mapping_Op_Group_Axis_To_Button:
+        case Gpad_Mapping_Op_Group_Axis_To_Axis:
+        case Gpad_Mapping_Op_Group_Axis_To_Half_Axis: {
+            // t = (calibrated - from) / (to - from) is 0..1 over the input range.
+            double from, to;
+            gpad__axis_input_range(elem, &from, &to);
+            const double t_scale = 1.0 / (to - from);
+            const double t_bias = -from * t_scale;
+            const double scale = calibration[elem.index].scale * t_scale;
+            const double bias = calibration[elem.index].bias * t_scale + t_bias;
+
+            if(group == Gpad_Mapping_Op_Group_Axis_To_Button) {
+                // Pressed past the middle of the input range, same as SDL.
+                op->scale = (float)scale;
+                op->bias = (float)(bias - 0.5);
+            } else {
+                const double range = (double)output_to - (double)output_from;
+                op->scale = (float)(scale * range);
+                op->bias = (float)(output_from + bias * range);
+                op->min = output_from < output_to ? output_from : output_to;
+                op->max = output_from < output_to ? output_to : output_from;
+            }
+        } break;
+    }
+}
+
+void gpad__compile_mapping(
+    const Gpad_Mapping* mapping, const Gpad_Axis_Calibration* calibration, Gpad_Compiled_Mapping* out_compiled) {
+    memset(out_compiled, 0, sizeof(Gpad_Compiled_Mapping));
+
+    int num_ops = 0;
+    for(int g = 0; g < Gpad_Mapping_Op_Group_COUNT; g++) {
+        const Gpad_Mapping_Op_Group group = (Gpad_Mapping_Op_Group)g;
+        for(int i = 0; i < Gpad_Button_COUNT; i++) {
+            gpad__compile_elem(out_compiled, &num_ops, group, mapping->buttons[i], calibration, i, false, false, 0, 0);
+        }
+
+        for(int i = 0; i < Gpad_Axis_COUNT; i++) {
+            // SDL has Y pointing down.
+            const float sign = i == Gpad_Axis_Left_Y || i == Gpad_Axis_Right_Y ? -1.0f : 1.0f;
+            if(mapping->half_axes & (1 << i)) {
+                gpad__compile_elem(out_compiled, &num_ops, group, mapping->axes[i], calibration, i, true, true, 0, sign);
+                gpad__compile_elem(
+                    out_compiled, &num_ops, group, mapping->negative_axes[i], calibration, i, true, true, 0, -sign);
+            } else {
+                gpad__compile_elem(out_compiled, &num_ops, group, mapping->axes[i], calibration, i, true, false, -sign, sign);
+            }
+        }
+
+        out_compiled->group_ends[group] = (uint8_t)num_ops;
+    }
+
+    for(int i = 0; i < Gpad_Axis_COUNT; i++) {
+        out_compiled->initial_axes[i] = mapping->half_axes & (1 << i) ? 0.0f : GPAD_AXIS_MIN;
+    }
+
+    for(int i = 0; i < Gpad_Button_COUNT; i++) {
+        const Gpad_Mapping_Elem elem = mapping->buttons[i];
+        if(elem.kind != Gpad_Mapping_Kind_Hatbit) continue;
+
+        const int hat = elem.index >> 4;
+        const int bits = elem.index & 0xf;
+        if(hat >= GPAD__MAX_RAW_HATS || bits == 0) continue;
+
+        for(int value = 0; value < 16; value++) {
+            if(value & bits) {
+                out_compiled->hat_buttons[hat][value] |= (uint16_t)(1 << i);
+            }
+        }
+        if(hat >= out_compiled->num_hats) {
+            out_compiled->num_hats = (uint8_t)(hat + 1);
+        }
+    }
+}
+
+static float gpad__clamp(const float value, const float min, const float max) {
+    if(value < min) return min;
+    if(value > max) return max;
+    return value;
+}
+
+// Everything but the axis to axis ops, those are at the end of the ops.
+static void gpad__evaluate_digital(
+    const Gpad_Compiled_Mapping* compiled, const Gpad_Raw_State* raw, Gpad_Device_State* out_state) {
+    out_state->buttons = 0;
+    memcpy(out_state->axes, compiled->initial_axes, sizeof(out_state->axes));
+
+    for(int hat = 0; hat < compiled->num_hats; hat++) {
+        out_state->buttons |= compiled->hat_buttons[hat][raw->hats[hat] & 0xf];
+    }
+
+    const Gpad_Mapping_Op* op = compiled->ops;
+    const Gpad_Mapping_Op* end = compiled->ops + compiled->group_ends[Gpad_Mapping_Op_Group_Button_To_Button];
+    for(; op < end; op++) {
+        out_state->buttons |= (uint16_t)(((raw->buttons >> op->input) & 1) << op->output);
+    }
+
+    end = compiled->ops + compiled->group_ends[Gpad_Mapping_Op_Group_Axis_To_Button];
+    for(; op < end; op++) {
+        out_state->buttons |= (uint16_t)(((float)raw->axes[op->input] * op->scale + op->bias >= 0.0f) << op->output);
+    }
+
+    end = compiled->ops + compiled->group_ends[Gpad_Mapping_Op_Group_Button_To_Axis];
+    for(; op < end; op++) {
+        out_state->axes[op->output] = (float)((raw->buttons >> op->input) & 1) * 2.0f - 1.0f;
+    }
+
+    end = compiled->ops + compiled->group_ends[Gpad_Mapping_Op_Group_Hat_To_Axis];
+    for(; op < end; op++) {
+        out_state->axes[op->output] = (float)((raw->hats[op->input] & op->hat_bits) != 0) * 2.0f - 1.0f;
+    }
+
+    end = compiled->ops + compiled->group_ends[Gpad_Mapping_Op_Group_Button_To_Half_Axis];
+    for(; op < end; op++) {
+        out_state->axes[op->output] += (float)((raw->buttons >> op->input) & 1) * op->scale;
+    }
+
+    end = compiled->ops + compiled->group_ends[Gpad_Mapping_Op_Group_Hat_To_Half_Axis];
+    for(; op < end; op++) {
+        out_state->axes[op->output] += (float)((raw->hats[op->input] & op->hat_bits) != 0) * op->scale;
+    }
+}
+
+void gpad__evaluate_mapping(
+    const Gpad_Compiled_Mapping* compiled, const Gpad_Raw_State* raw, Gpad_Device_State* out_state) {
+    Gpad_Device_State result;
+    gpad__evaluate_digital(compiled, raw, &result);
+
+    const Gpad_Mapping_Op* op = compiled->ops + compiled->group_ends[Gpad_Mapping_Op_Group_Hat_To_Half_Axis];
+    const Gpad_Mapping_Op* end = compiled->ops + compiled->group_ends[Gpad_Mapping_Op_Group_Axis_To_Axis];
+    for(; op < end; op++) {
+        result.axes[op->output] = gpad__clamp(
+            (float)raw->axes[op->input] * op->scale + op->bias, op->min, op->max);
+    }
+
+    end = compiled->ops + compiled->group_ends[Gpad_Mapping_Op_Group_Axis_To_Half_Axis];
+    for(; op < end; op++) {
+        result.axes[op->output] += gpad__clamp(
+            (float)raw->axes[op->input] * op->scale + op->bias, op->min, op->max);
+    }
+
+    *out_state = result;
+}
+
+void gpad__build_axis_batch(
+    Gpad_Axis_Batch* batch, const Gpad_Compiled_Mapping* const* compiled, const int num_devices) {
+    memset(batch, 0, sizeof(Gpad_Axis_Batch));
+
+    for(int device = 0; device < num_devices && device < GPAD_MAX_DEVICES; device++) {
+        if(!compiled[device]) continue;
+
+        const Gpad_Compiled_Mapping* mapping = compiled[device];
+        const int begin = mapping->group_ends[Gpad_Mapping_Op_Group_Hat_To_Half_Axis];
+        const int end = mapping->group_ends[Gpad_Mapping_Op_Group_Axis_To_Half_Axis];
+        for(int i = begin; i < end; i++) {
+            const Gpad_Mapping_Op* op = &mapping->ops[i];
+            const int index = batch->count++;
+            batch->devices[index] = (uint8_t)device;
+            batch->inputs[index] = op->input;
+            batch->outputs[index] = op->output;
+            batch->half[index] = i >= mapping->group_ends[Gpad_Mapping_Op_Group_Axis_To_Axis];
+            batch->scale[index] = op->scale;
+            batch->bias[index] = op->bias;
+            batch->min[index] = op->min;
+            batch->max[index] = op->max;
+        }
+    }
+}
+
+// values[i] = clamp(raw[i] * scale[i] + bias[i], min[i], max[i]). Count is a multiple of 8.
+static void gpad__normalize_axes(Gpad_Axis_Batch* batch, const int count) {
+#if defined(GPAD__AVX2)
+    for(int i = 0; i < count; i += 8) {
+        const __m256 raw = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)&batch->raw[i]));
+        __m256 value = _mm256_mul_ps(raw, _mm256_loadu_ps(&batch->scale[i]));
+        value = _mm256_add_ps(value, _mm256_loadu_ps(&batch->bias[i]));
+        value = _mm256_min_ps(_mm256_max_ps(value, _mm256_loadu_ps(&batch->min[i])), _mm256_loadu_ps(&batch->max[i]));
+        _mm256_storeu_ps(&batch->values[i], value);
+    }
+#elif defined(GPAD__SSE2)
+    for(int i = 0; i < count; i += 4) {
+        const __m128 raw = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)&batch->raw[i]));
+        __m128 value = _mm_mul_ps(raw, _mm_loadu_ps(&batch->scale[i]));
+        value = _mm_add_ps(value, _mm_loadu_ps(&batch->bias[i]));
+        value = _mm_min_ps(_mm_max_ps(value, _mm_loadu_ps(&batch->min[i])), _mm_loadu_ps(&batch->max[i]));
+        _mm_storeu_ps(&batch->values[i], value);
+    }
+#else
+    for(int i = 0; i < count; i++) {
+        const float value = (float)batch->raw[i] * batch->scale[i] + batch->bias[i];
+        batch->values[i] = gpad__clamp(value, batch->min[i], batch->max[i]);
+    }
+#endif
+}
+
+void gpad__evaluate_mappings(
+    Gpad_Axis_Batch* batch,
+    const Gpad_Compiled_Mapping* const* compiled,
+    const Gpad_Raw_State* const* raw,
+    Gpad_Device_State* const* out_states,
+    const bool* changed,
+    const int num_devices) {
+    // Gathering and normalizing the whole batch only pays off when every device changed, usually only one or two
+    // did. Those are faster one by one.
+    bool all_changed = true;
+    for(int device = 0; device < num_devices && changed && all_changed; device++) {
+        all_changed = !compiled[device] || changed[device];
+    }
+    if(!all_changed) {
+        for(int device = 0; device < num_devices; device++) {
+            if(!compiled[device] || !changed[device]) continue;
+            gpad__evaluate_mapping(compiled[device], raw[device], out_states[device]);
+        }
+        return;
+    }
+
+    for(int device = 0; device < num_devices; device++) {
+        if(!compiled[device]) continue;
+        gpad__evaluate_digital(compiled[device], raw[device], out_states[device]);
+    }
+
+    for(int i = 0; i < batch->count; i++) {
+        batch->raw[i] = raw[batch->devices[i]]->axes[batch->inputs[i]];
+    }
+
+    gpad__normalize_axes(batch, (batch->count + 7) & ~7);
+
+    for(int i = 0; i < batch->count; i++) {
+        float* axis = &out_states[batch->devices[i]]->axes[batch->outputs[i]];
+        *axis = batch->half[i] ? *axis + batch->values[i] : batch->values[i];
+    }
+}
+
+//
+// Runtime loading of the SDL gamecontrollerdb.txt format.
+// Lines look like: GUID,name,a:b0,leftx:a0,-lefty:a1~,dpup:h0.1,...,platform:Linux,
+// Everything is parsed in place from the input. Lines are found with memchr, fields in a single pass over the line.
+//
+
+static bool gpad__str_equal(const char* str, const char* end, const char* other, const size_t other_len) {
+    return (size_t)(end - str) == other_len && memcmp(str, other, other_len) == 0;
+}
+
+#define GPAD__STR_EQUAL(str, end, literal) gpad__str_equal(str, end, literal, sizeof(literal) - 1)
+
+// Returns the end of the number or NULL if there are no digits.
+static const char* gpad__parse_uint(const char* str, const char* end, int* out_value) {
+    if(str >= end || *str < '0' || *str > '9') {
+        return NULL;
+    }
+    int value = 0;
+    for(; str < end && *str >= '0' && *str <= '9' && value < 256; str++) {
+        value = value * 10 + (*str - '0');
+    }
+    *out_value = value;
+    return str;
+}
+
+// Element like "b0", "a2", "+a3", "-a1", "a2~" or "h0.4". Same encoding as build_db.
+static bool gpad__parse_mapping_elem(Gpad_Mapping_Elem* out_elem, const char* str, const char* end) {
+    Gpad_Mapping_Elem elem = {0};
+    int minimum = -1;
+    int maximum = 1;
+
+    if(str < end && *str == '+') {
+        minimum = 0;
+        str++;
+    } else if(str < end && *str == '-') {
+        maximum = 0;
+        str++;
+    }
+
+    const bool invert = end > str && end[-1] == '~';
+    if(invert) end--;
+
+    if(str >= end) return false;
+    switch(*str++) {
+        case 'a': elem.kind = Gpad_Mapping_Kind_Axis; break;
+        case 'b': elem.kind = Gpad_Mapping_Kind_Button; break;
+        case 'h': elem.kind = Gpad_Mapping_Kind_Hatbit; break;
+        default: return false;
+    }
+
+    int index = 0;
+    str = gpad__parse_uint(str, end, &index);
+    if(!str) return false;
+
+    if(elem.kind == Gpad_Mapping_Kind_Hatbit) {
+        int bit = 0;
+        if(str >= end || *str != '.') return false;
+        str = gpad__parse_uint(str + 1, end, &bit);
+        if(!str) return false;
+        index = (index << 4) | bit;
+    }
+
+    if(str != end || index > 0xff) return false;
+    elem.index = (uint8_t)index;
+
+    if(elem.kind == Gpad_Mapping_Kind_Axis) {
+        elem.axis_scale = (int8_t)(2 / (maximum - minimum));
+        elem.axis_offset = (int8_t)-(maximum + minimum);
+        if(invert) {
+            elem.axis_scale *= -1;
+            elem.axis_offset *= -1;
+        }
+    }
+
+    *out_elem = elem;
+    return true;
+}
+
+static void gpad__init_sdl_field_table(void) {
+    if(g_gpad_sdl_field_table[GPAD__SDL_FIELD_HASH('a', 'a', 1)]) return;
+    for(int i = 0; i < (int)(sizeof(g_gpad_sdl_fields) / sizeof(g_gpad_sdl_fields[0])); i++) {
+        const Gpad_Sdl_Field* sdl_field = &g_gpad_sdl_fields[i];
+        const int hash = GPAD__SDL_FIELD_HASH(
+            (uint8_t)sdl_field->name[0], (uint8_t)sdl_field->name[sdl_field->len - 1], sdl_field->len);
+        g_gpad_sdl_field_table[hash] = (uint8_t)(i + 1);
+    }
+}
+
+// Field like "a:b0" or "+leftx:h0.2". Unknown fields are ignored.
+static void gpad__parse_mapping_field(
+    Gpad_Mapping* mapping, const char* ident, const char* ident_end, const char* value, const char* value_end) {
+    // Output modifier, the input only drives one half of the axis.
+    const char modifier = *ident;
+    const bool half = modifier == '+' || modifier == '-';
+    if(half) ident++;
+
+    const int len = (int)(ident_end - ident);
+    if(len <= 0) return;
+    const int slot = g_gpad_sdl_field_table[GPAD__SDL_FIELD_HASH((uint8_t)ident[0], (uint8_t)ident_end[-1], len)];
+    if(slot == 0) return;
+    const Gpad_Sdl_Field* sdl_field = &g_gpad_sdl_fields[slot - 1];
+    if(!gpad__str_equal(ident, ident_end, sdl_field->name, sdl_field->len)) return;
+
+    if(!sdl_field->axis) {
+        if(!half) {
+            gpad__parse_mapping_elem(&mapping->buttons[sdl_field->index], value, value_end);
+        }
+    } else if(!half) {
+        gpad__parse_mapping_elem(&mapping->axes[sdl_field->index], value, value_end);
+    } else {
+        Gpad_Mapping_Elem* elem = modifier == '+' ? &mapping->axes[sdl_field->index]
+                                                  : &mapping->negative_axes[sdl_field->index];
+        if(gpad__parse_mapping_elem(elem, value, value_end)) {
+            mapping->half_axes |= 1 << sdl_field->index;
+        }
+    }
+}
+
+// Fields like "a:b0,leftx:a0,platform:Linux". Returns false if they're for another platform.
+static bool gpad__parse_mapping_fields(Gpad_Mapping* mapping, const char* field, const char* end) {
+    gpad__init_sdl_field_table();
+    const char* colon = NULL;
+    for(const char* c = field; c <= end; c++) {
+        if(c < end && *c != ',') {
+            if(*c == ':' && !colon) colon = c;
+            continue;
+        }
+
+        if(colon) {
+            const char* value = colon + 1;
+            if(GPAD__STR_EQUAL(field, colon, "platform")) {
+                if(!GPAD__STR_EQUAL(value, c, GPAD__PLATFORM_NAME)) return false;
+            } else {
+                gpad__parse_mapping_field(mapping, field, colon, value, c);
+            }
+        }
+
+        field = c + 1;
+        colon = NULL;
+    }
+    return true;
+}
+
+// Returns the mapping index or -1 if the runtime storage is full.
+// A GUID which is already loaded is replaced in place, devices using it see the new mapping.
+static int gpad__set_runtime_mapping(
+    const Gpad_Guid* guid, const char* name, size_t name_len, const Gpad_Mapping* mapping, const bool generic) {
+    uint16_t* slot = gpad__runtime_slot(guid);
+    if(*slot == 0) {
+        if(g_gpad_runtime_mappings.count >= GPAD_MAX_RUNTIME_MAPPINGS) return -1;
+        *slot = (uint16_t)(++g_gpad_runtime_mappings.count);
+    }
+
+    const int index = *slot - 1;
+    g_gpad_runtime_mappings.guids[index] = *guid;
+    g_gpad_runtime_mappings.mappings[index] = *mapping;
+    g_gpad_runtime_mappings.generic[index] = generic;
+
+    if(name_len > GPAD__RUNTIME_NAME_SIZE - 1) name_len = GPAD__RUNTIME_NAME_SIZE - 1;
+    memcpy(&g_gpad_runtime_mappings.names[index][0], name, name_len);
+    g_gpad_runtime_mappings.names[index][name_len] = 0;
+
+    Gpad_Guid key;
+    if(!generic && gpad__guid_key(guid, &key)) {
+        *gpad__runtime_key_slot(&key) = *slot;
+    }
+
+    return GPAD__NUM_DATABASE_MAPPINGS + index;
+}
+
+// Returns false for comments, invalid lines and mappings for other platforms.
+static bool gpad__add_mapping_line(const char* line, const char* end) {
+    while(end > line && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) end--;
+    while(line < end && (*line == ' ' || *line == '\t')) line++;
+    if(line >= end || *line == '#') return false;
+
+    const char* guid_end = (const char*)memchr(line, ',', end - line);
+    if(!guid_end || guid_end - line != 32) return false;
+
+    Gpad_Guid guid;
+    for(int i = 0; i < 16; i++) {
+        const int hi = gpad__hex_digit(line[i * 2]);
+        const int lo = gpad__hex_digit(line[i * 2 + 1]);
+        if(hi < 0 || lo < 0) return false;
+        guid.data[i] = (uint8_t)((hi << 4) | lo);
+    }
+
+    const char* name = guid_end + 1;
+    const char* name_end = (const char*)memchr(name, ',', end - name);
+    if(!name_end) return false;
+
+    // The platform is almost always the last field. Checking it first skips lines for other platforms without parsing them.
+    const char* last_end = end;
+    if(last_end > name_end && last_end[-1] == ',') last_end--;
+    const char* last = last_end;
+    while(last > name_end && last[-1] != ',') last--;
+    if(last_end - last > 9 && memcmp(last, "platform:", 9) == 0 &&
+       !GPAD__STR_EQUAL(last + 9, last_end, GPAD__PLATFORM_NAME)) {
+        return false;
+    }
+
+    Gpad_Mapping mapping = {0};
+    if(!gpad__parse_mapping_fields(&mapping, name_end + 1, end)) return false;
+
+    return gpad__set_runtime_mapping(&guid, name, name_end - name, &mapping, false) >= 0;
+}
+
+int gpad__add_generic_mapping(const Gpad_Guid* guid, const char* fields) {
+    // Never replaces a real mapping.
+    const uint16_t value = *gpad__runtime_slot(guid);
+    if(value != 0 && !g_gpad_runtime_mappings.generic[value - 1]) {
+        return GPAD__NUM_DATABASE_MAPPINGS + value - 1;
+    }
+
+    Gpad_Mapping mapping = {0};
+    gpad__parse_mapping_fields(&mapping, fields, fields + strlen(fields));
+    return gpad__set_runtime_mapping(guid, "Generic", sizeof("Generic") - 1, &mapping, true);
+}
+
+// Doesn't rebind connected devices, so chunked loads can do it once at the end.
+static int gpad__load_mapping_lines(const char* data, size_t size) {
+    int count = 0;
+    const char* end = data + size;
+    while(data < end) {
+        const char* line_end = (const char*)memchr(data, '\n', end - data);
+        if(!line_end) line_end = end;
+
+        if(gpad__add_mapping_line(data, line_end)) {
+            count++;
+        }
+
+        data = line_end + (line_end < end);
+    }
+    return count;
+}
+
+int gpad_load_mappings_from_memory(const char* data, size_t size) {
+    if(!data) return -1;
+
+    const int count = gpad__load_mapping_lines(data, size);
+    if(count > 0 && gpad_is_initialized()) {
+        gpad__rebind_devices();
+    }
+    return count;
+}
+
+bool gpad_add_mapping(const char* mapping) {
+    if(!mapping) return false;
+    if(!gpad__add_mapping_line(mapping, mapping + strlen(mapping))) return false;
+
+    if(gpad_is_initialized()) {
+        gpad__rebind_devices();
+    }
+    return true;
+}
+
+int gpad_load_mappings_from_file(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if(!file) return -1;
+
+    // Complete lines are parsed straight from the buffer, only the unfinished last line is moved to the front.
+    // Lines which don't fit are skipped, real mappings are far shorter.
+    char buffer[16 * 1024];
+    size_t used = 0;
+    bool skip_line = false;
+    int count = 0;
+
+    for(;;) {
+        const size_t read = fread(&buffer[used], 1, sizeof(buffer) - used, file);
+        used += read;
+
+        if(read == 0) {
+            if(!skip_line) {
+                count += gpad__load_mapping_lines(buffer, used);
+            }
+            break;
+        }
+
+        size_t start = 0;
+        if(skip_line) {
+            const char* newline = (const char*)memchr(buffer, '\n', used);
+            if(!newline) {
+                used = 0;
+                continue;
+            }
+            start = newline - buffer + 1;
+            skip_line = false;
+        }
+
+        size_t last_line = used;
+        while(last_line > start && buffer[last_line - 1] != '\n') last_line--;
+
+        if(last_line == 0 && used == sizeof(buffer)) {
+            skip_line = true;
+            used = 0;
+            continue;
+        }
+
+        count += gpad__load_mapping_lines(&buffer[start], last_line - start);
+        memmove(buffer, &buffer[last_line], used - last_line);
+        used -= last_line;
+    }
+
+    const bool failed = ferror(file) != 0;
+    fclose(file);
+
+    if(count > 0 && gpad_is_initialized()) {
+        gpad__rebind_devices();
+    }
+    return failed ? -1 : count;
+}
+
+void gpad__load_env_mappings(void) {
+    const char* config = getenv("SDL_GAMECONTROLLERCONFIG");
+    if(config) {
+        gpad_load_mappings_from_memory(config, strlen(config));
+    }
+}
+
+//
+// Precompiled binary database, mapped read-only and used in place.
+//
+
+static const void* gpad__map_file(const char* path, size_t* out_size) {
+#ifdef GPAD_PLATFORM_WINDOWS
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE) return NULL;
+
+    const void* result = NULL;
+    LARGE_INTEGER size;
+    if(GetFileSizeEx(file, &size) && size.QuadPart > 0 && (uint64_t)size.QuadPart <= UINT32_MAX) {
+        // The view keeps the mapping alive, both handles can be closed right away.
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if(mapping) {
+            result = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            *out_size = (size_t)size.QuadPart;
+        }
+    }
+    CloseHandle(file);
+    return result;
+#else
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return NULL;
+
+    const void* result = NULL;
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size > 0 && (uint64_t)st.st_size <= UINT32_MAX) {
+        void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data != MAP_FAILED) {
+            result = data;
+            *out_size = (size_t)st.st_size;
+        }
+    }
+    close(fd);
+    return result;
+#endif
+}
+
+static void gpad__unmap_file(const void* data, const size_t size) {
+#ifdef GPAD_PLATFORM_WINDOWS
+    (void)size;
+    UnmapViewOfFile(data);
+#else
+    munmap((void*)data, size);
+#endif
+}
+
+static bool gpad__database_section_valid(const Gpad_Database_Header* header, const uint32_t offset, const uint64_t size) {
+    return offset % 8 == 0 && offset >= sizeof(Gpad_Database_Header) && offset + size <= header->size;
+}
+
+static bool gpad__is_power_of_two(const uint32_t x) {
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+// Checks everything the lookups rely on, the file is trusted after this.
+static bool gpad__database_from_file(Gpad_Database* out_db, const uint8_t* data, const size_t size) {
+    if(size < sizeof(Gpad_Database_Header)) return false;
+
+    const Gpad_Database_Header* header = (const Gpad_Database_Header*)data;
+    if(memcmp(header->magic, "GPDB", 4) != 0) return false;
+    if(header->version != GPAD_DATABASE_VERSION || header->size != size) return false;
+    if(strncmp(header->platform, GPAD__PLATFORM_NAME, sizeof(header->platform)) != 0) return false;
+
+    // Indices past the database are used by runtime mappings.
+    if(header->num_rows == 0 || header->num_rows > GPAD_MAPPING_INDEX_INVALID - GPAD_MAX_RUNTIME_MAPPINGS) return false;
+    if(!gpad__is_power_of_two(header->num_buckets) || !gpad__is_power_of_two(header->num_slots) ||
+       !gpad__is_power_of_two(header->num_key_buckets) || !gpad__is_power_of_two(header->num_key_slots)) {
+        return false;
+    }
+    if(header->names_size == 0) return false;
+
+    if(!gpad__database_section_valid(header, header->guids_offset, (uint64_t)header->num_rows * sizeof(Gpad_Guid)) ||
+       !gpad__database_section_valid(header, header->rows_offset, (uint64_t)header->num_rows * sizeof(Gpad_Mapping_Row)) ||
+       !gpad__database_section_valid(header, header->pool_offset, (uint64_t)header->num_pool * sizeof(Gpad_Mapping)) ||
+       !gpad__database_section_valid(header, header->displacements_offset, (uint64_t)header->num_buckets * 2) ||
+       !gpad__database_section_valid(header, header->slots_offset, (uint64_t)header->num_slots * 2) ||
+       !gpad__database_section_valid(header, header->names_offset, header->names_size) ||
+       !gpad__database_section_valid(header, header->key_displacements_offset, (uint64_t)header->num_key_buckets * 2) ||
+       !gpad__database_section_valid(header, header->key_slots_offset, (uint64_t)header->num_key_slots * 2)) {
+        return false;
+    }
+
+    // Rejects stale or partially written files.
+    if(gpad__database_checksum(data + sizeof(Gpad_Database_Header), size - sizeof(Gpad_Database_Header)) !=
+       header->checksum) {
+        return false;
+    }
+
+    const Gpad_Mapping_Row* rows = (const Gpad_Mapping_Row*)(data + header->rows_offset);
+    const char* names = (const char*)(data + header->names_offset);
+    if(names[header->names_size - 1] != 0) return false;
+    for(uint32_t i = 0; i < header->num_rows; i++) {
+        if(rows[i].pool_index >= header->num_pool || rows[i].name_offset >= header->names_size) return false;
+    }
+
+    out_db->guids = (const Gpad_Guid*)(data + header->guids_offset);
+    out_db->rows = rows;
+    out_db->pool = (const Gpad_Mapping*)(data + header->pool_offset);
+    out_db->displacements = (const uint16_t*)(data + header->displacements_offset);
+    out_db->slots = (const uint16_t*)(data + header->slots_offset);
+    out_db->names = names;
+    out_db->key_displacements = (const uint16_t*)(data + header->key_displacements_offset);
+    out_db->key_slots = (const uint16_t*)(data + header->key_slots_offset);
+    out_db->num_rows = header->num_rows;
+    out_db->num_buckets = header->num_buckets;
+    out_db->num_slots = header->num_slots;
+    out_db->num_key_buckets = header->num_key_buckets;
+    out_db->num_key_slots = header->num_key_slots;
+    return true;
+}
+
+bool gpad_load_database_file(const char* path) {
+    // Mapping indices of connected devices would point into the old database.
+    if(gpad_is_initialized()) return false;
+
+    size_t size = 0;
+    const void* data = gpad__map_file(path, &size);
+    if(!data) return false;
+
+    Gpad_Database db;
+    if(!gpad__database_from_file(&db, (const uint8_t*)data, size)) {
+        gpad__unmap_file(data, size);
+        return false;
+    }
+
+    if(g_gpad_database_file) {
+        gpad__unmap_file(g_gpad_database_file, g_gpad_database_file_size);
+    }
+    g_gpad_database = db;
+    g_gpad_database_file = data;
+    g_gpad_database_file_size = size;
+    return true;
+}
@@ -0,0 +1,261 @@
+#ifndef GPAD_MAPPING_H_INCLUDED
+#define GPAD_MAPPING_H_INCLUDED
+
+// Internal header shared by the platform backends. Not part of the public API.
+
+#include "gpad.h"
+
+#include <string.h>
+
+typedef uint16_t Gpad_Mapping_Index;
+#define GPAD_MAPPING_INDEX_INVALID ((Gpad_Mapping_Index)~0)
+
+typedef uint8_t Gpad_Mapping_Kind;
+
+typedef enum Gpad_Mapping_Kind_ {
+    Gpad_Mapping_Kind_Axis,
+    Gpad_Mapping_Kind_Button,
+    Gpad_Mapping_Kind_Hatbit,
+} Gpad_Mapping_Kind_;
+
+typedef struct Gpad_Mapping_Elem {
+    Gpad_Mapping_Kind kind;
+    uint8_t index;
+    int8_t axis_scale;
+    int8_t axis_offset;
+} Gpad_Mapping_Elem;
+
+// Limits of the raw device state the mappings index into.
+#define GPAD__MAX_RAW_BUTTONS 64
+#define GPAD__MAX_RAW_AXES 32
+#define GPAD__MAX_RAW_HATS 4
+
+// Maps a raw axis value to [-1, 1] with one multiply-add. Zero for axes the device doesn't have, those read 0.
+// Baked into the compiled mapping, see gpad__compile_mapping.
+typedef struct Gpad_Axis_Calibration {
+    float scale;
+    float bias;
+} Gpad_Axis_Calibration;
+
+// Raw device state in SDL joystick order, filled by the backends and mapped by gpad__evaluate_mapping.
+typedef struct Gpad_Raw_State {
+    uint64_t buttons; // Bit per button
+    int32_t axes[GPAD__MAX_RAW_AXES];
+    uint8_t hats[GPAD__MAX_RAW_HATS]; // SDL hat bits: 1 up, 2 right, 4 down, 8 left
+} Gpad_Raw_State;
+
+typedef uint8_t Gpad_Mapping_Op_Group;
+
+// Ops of a compiled mapping are grouped by input and output kind, gpad__evaluate_mapping runs one loop per group.
+typedef enum Gpad_Mapping_Op_Group_ {
+    Gpad_Mapping_Op_Group_Button_To_Button,
+    Gpad_Mapping_Op_Group_Axis_To_Button,
+    Gpad_Mapping_Op_Group_Button_To_Axis,
+    Gpad_Mapping_Op_Group_Hat_To_Axis,
+    Gpad_Mapping_Op_Group_Button_To_Half_Axis,
+    Gpad_Mapping_Op_Group_Hat_To_Half_Axis,
+    // Axis to axis ops come last, gpad__evaluate_mappings runs them separately.
+    Gpad_Mapping_Op_Group_Axis_To_Axis,
+    Gpad_Mapping_Op_Group_Axis_To_Half_Axis,
+    Gpad_Mapping_Op_Group_COUNT,
+} Gpad_Mapping_Op_Group_;
+
+typedef struct Gpad_Mapping_Op {
+    uint8_t input; // Raw button, hat or axis index
+    uint8_t output; // Gpad_Button or Gpad_Axis
+    uint8_t hat_bits; // Hat inputs only
+    // Axis inputs: raw value * scale + bias, with the calibration, SDL input range, Y flip and output half baked in.
+    // Buttons are pressed when it's >= 0, axes clamp it to [min, max].
+    // Buttons and hats to half axes: scale is added when pressed.
+    float scale;
+    float bias;
+    float min;
+    float max;
+} Gpad_Mapping_Op;
+
+// Every button plus both halves of every axis.
+#define GPAD__MAX_MAPPING_OPS (Gpad_Button_COUNT + Gpad_Axis_COUNT * 2)
+
+// A Gpad_Mapping resolved once when a device connects, unmapped elements are left out.
+typedef struct Gpad_Compiled_Mapping {
+    Gpad_Mapping_Op ops[GPAD__MAX_MAPPING_OPS];
+    uint8_t group_ends[Gpad_Mapping_Op_Group_COUNT]; // Groups are stored in order, each ends where the next starts
+    float initial_axes[Gpad_Axis_COUNT]; // GPAD_AXIS_MIN, 0 for half axes which are summed up
+    // Buttons pressed for every value of every hat, so hats need no ops.
+    uint16_t hat_buttons[GPAD__MAX_RAW_HATS][16];
+    uint8_t num_hats; // Hats used for buttons
+} Gpad_Compiled_Mapping;
+
+// Axis to axis ops of up to GPAD_MAX_DEVICES devices in struct of arrays layout, for gpad__evaluate_mappings.
+// Padded to a multiple of 8 with ops which read 0.
+#define GPAD__MAX_BATCH_AXES ((GPAD_MAX_DEVICES * Gpad_Axis_COUNT * 2 + 7) & ~7)
+
+typedef struct Gpad_Axis_Batch {
+    int count;
+    // Copied from the ops by gpad__build_axis_batch.
+    uint8_t devices[GPAD__MAX_BATCH_AXES];
+    uint8_t inputs[GPAD__MAX_BATCH_AXES];
+    uint8_t outputs[GPAD__MAX_BATCH_AXES];
+    bool half[GPAD__MAX_BATCH_AXES];
+    float scale[GPAD__MAX_BATCH_AXES];
+    float bias[GPAD__MAX_BATCH_AXES];
+    float min[GPAD__MAX_BATCH_AXES];
+    float max[GPAD__MAX_BATCH_AXES];
+    // Gathered raw values and their results, filled in by gpad__evaluate_mappings.
+    int32_t raw[GPAD__MAX_BATCH_AXES];
+    float values[GPAD__MAX_BATCH_AXES];
+} Gpad_Axis_Batch;
+
+// Binary SDL GUID, same byte order as the hex string in gamecontrollerdb.txt.
+typedef union Gpad_Guid {
+    uint8_t data[16];
+    uint64_t words[2];
+} Gpad_Guid;
+
+// Identical mappings are shared by all GUIDs which use them.
+typedef struct Gpad_Mapping {
+    Gpad_Mapping_Elem buttons[Gpad_Button_COUNT];
+    Gpad_Mapping_Elem axes[Gpad_Axis_COUNT];
+    // SDL output modifiers, like "-leftx:h0.8,+leftx:h0.2". For axes with their bit in half_axes,
+    // axes[i] drives the positive half and negative_axes[i] the negative one.
+    Gpad_Mapping_Elem negative_axes[Gpad_Axis_COUNT];
+    uint8_t half_axes;
+} Gpad_Mapping;
+
+// One per GUID in the database.
+typedef struct Gpad_Mapping_Row {
+    uint16_t pool_index; // Into g_gpad_mapping_pool
+    uint16_t name_offset; // Into g_gpad_mapping_names
+} Gpad_Mapping_Row;
+
+// Binary database file, see gpad_load_database_file. Generated by build_db.
+// Little endian, the file is used in place so all sections are 8 byte aligned.
+#define GPAD_DATABASE_VERSION 3
+
+typedef struct Gpad_Database_Header {
+    char magic[4]; // "GPDB"
+    uint32_t version;
+    uint32_t size; // Of the whole file
+    uint32_t checksum; // FNV-1a of everything after the header
+    char platform[16]; // Zero terminated, same as in gamecontrollerdb.txt
+    uint32_t num_rows;
+    uint32_t num_pool;
+    uint32_t num_buckets;
+    uint32_t num_slots;
+    uint32_t names_size;
+    uint32_t num_key_buckets;
+    uint32_t num_key_slots;
+    // Offsets from the start of the file.
+    uint32_t guids_offset; // Gpad_Guid[num_rows]
+    uint32_t rows_offset; // Gpad_Mapping_Row[num_rows]
+    uint32_t pool_offset; // Gpad_Mapping[num_pool]
+    uint32_t displacements_offset; // uint16_t[num_buckets]
+    uint32_t slots_offset; // uint16_t[num_slots]
+    uint32_t names_offset; // char[names_size]
+    uint32_t key_displacements_offset; // uint16_t[num_key_buckets]
+    uint32_t key_slots_offset; // uint16_t[num_key_slots]
+    uint32_t reserved;
+} Gpad_Database_Header;
+
+#define GPAD__NUM_MAPPINGS (gpad__mapping_count())
+
+static inline bool gpad__guid_equal(const Gpad_Guid* a, const Gpad_Guid* b) {
+    return a->words[0] == b->words[0] && a->words[1] == b->words[1];
+}
+
+// Hash of the perfect hash index, shared with build_db.
+static inline uint32_t gpad__guid_hash(const Gpad_Guid* guid, const uint32_t seed) {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+    for(int i = 0; i < 8; i++) {
+        lo |= (uint64_t)guid->data[i] << (i * 8);
+        hi |= (uint64_t)guid->data[i + 8] << (i * 8);
+    }
+    uint64_t h = (uint64_t)seed * 0x9E3779B97F4A7C15ull + lo;
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ull;
+    h ^= hi;
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ull;
+    h ^= h >> 32;
+    return (uint32_t)h;
+}
+
+// Bus, vendor and product of a GUID in the standard form (bus, crc, vendor, 0, product, 0, version, driver data),
+// with everything else zeroed. Key of the fallback index, shared with build_db.
+// Returns false for GUIDs made from the device name, those have no IDs.
+static inline bool gpad__guid_key(const Gpad_Guid* guid, Gpad_Guid* out_key) {
+    const uint8_t* data = guid->data;
+    if(data[6] || data[7] || data[10] || data[11]) return false;
+    if(!data[4] && !data[5] && !data[8] && !data[9]) return false;
+    memset(out_key, 0, sizeof(Gpad_Guid));
+    out_key->data[0] = data[0];
+    out_key->data[1] = data[1];
+    out_key->data[4] = data[4];
+    out_key->data[5] = data[5];
+    out_key->data[8] = data[8];
+    out_key->data[9] = data[9];
+    return true;
+}
+
+// FNV-1a, checksum of the database file.
+static inline uint32_t gpad__database_checksum(const uint8_t* data, const size_t size) {
+    uint32_t h = 2166136261u;
+    for(size_t i = 0; i < size; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of mappings in the database for the current platform.
+int gpad__mapping_count(void);
+// Returns -1 on failure. O(1), uses the perfect hash index generated into the database.
+int gpad__find_mapping(const Gpad_Guid* guid);
+// Mapping for a connected device, falls back to close matches when the exact GUID is missing:
+// without the CRC, without the version, without both, then any mapping with the same bus, vendor and product.
+// Returns -1 if there is none, the backend should then make up a layout with gpad__add_generic_mapping.
+int gpad__resolve_mapping(const Gpad_Guid* guid);
+// Adds SDL mapping fields like "a:b0,leftx:a0" as a runtime mapping for the GUID, named "Generic".
+// Lookups never return it, calling this again for the same GUID reuses the index.
+// Returns the mapping index or -1 if the runtime storage is full.
+int gpad__add_generic_mapping(const Gpad_Guid* guid, const char* fields);
+// The index must be valid. With a compressed database the mapping may be decoded into a small cache,
+// so don't keep the pointer across calls.
+const Gpad_Mapping* gpad__get_mapping(Gpad_Mapping_Index index);
+// The index must be valid.
+const char* gpad__mapping_name(Gpad_Mapping_Index index);
+const char* gpad__mapping_kind_name(Gpad_Mapping_Kind kind);
+// Called by the backends when a device connects or its mapping changes.
+// The calibration has one entry per raw axis, GPAD__MAX_RAW_AXES.
+void gpad__compile_mapping(
+    const Gpad_Mapping* mapping, const Gpad_Axis_Calibration* calibration, Gpad_Compiled_Mapping* out_compiled);
+// Maps the raw state to the Xbox layout. Platform independent, shared by all backends which use mappings.
+void gpad__evaluate_mapping(
+    const Gpad_Compiled_Mapping* compiled, const Gpad_Raw_State* raw, Gpad_Device_State* out_state);
+// Collects the axis ops of num_devices compiled mappings, which may be NULL for unused IDs.
+// Has to be called again whenever one of them changes.
+void gpad__build_axis_batch(Gpad_Axis_Batch* batch, const Gpad_Compiled_Mapping* const* compiled, int num_devices);
+// Same as gpad__evaluate_mapping for every device with changed[device] set, the others keep their state and their
+// raw state isn't read. Pass NULL to evaluate all of them. When all devices changed, their axes are normalized in one
+// SIMD pass. Uses SSE2 or AVX2 when the compiler targets them, define GPAD_NO_SIMD for plain C.
+void gpad__evaluate_mappings(
+    Gpad_Axis_Batch* batch,
+    const Gpad_Compiled_Mapping* const* compiled,
+    const Gpad_Raw_State* const* raw,
+    Gpad_Device_State* const* out_states,
+    const bool* changed,
+    int num_devices);
+// Loads SDL_GAMECONTROLLERCONFIG, called by gpad_initialize.
+void gpad__load_env_mappings(void);
+// Implemented by the backends. Resolves the mappings of connected devices again after runtime mappings changed.
+void gpad__rebind_devices(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GPAD_MAPPING_H_INCLUDED
@@ -1,6 +1,7 @@
 #if _WIN32
 #define GPAD_PLATFORM_WINDOWS
 #include "gpad.h"
+#include "gpad_mapping.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -19,96 +20,6 @@
 #pragma comment(lib, "xinput.lib")
 
 
-typedef uint16_t Gpad_Mapping_Index;
-#define GPAD_MAPPING_INDEX_INVALID ((Gpad_Mapping_Index)~0)
-
-typedef uint8_t Gpad_Mapping_Kind;
-
-typedef enum Gpad_Mapping_Kind_ {
-    Gpad_Mapping_Kind_Axis,
-    Gpad_Mapping_Kind_Button,
-    Gpad_Mapping_Kind_Hatbit,
-} Gpad_Mapping_Kind_;
-
-typedef struct Gpad_Mapping_Elem {
-    Gpad_Mapping_Kind kind;
-    uint8_t index;
-    int8_t axis_scale;
-    int8_t axis_offset;
-} Gpad_Mapping_Elem;
-
-// String, last char is 0.
-typedef char Gpad_Guid[33];
-
-typedef struct Gpad_Mapping {
-    const char* name;
-    Gpad_Mapping_Elem buttons[Gpad_Button_COUNT];
-    Gpad_Mapping_Elem axes[Gpad_Axis_COUNT];
-} Gpad_Mapping;
-
-#include "gpad_gamecontrollerdb.inl"
-
-#define GPAD__NUM_MAPPINGS (sizeof(g_gpad_mappings) / sizeof(g_gpad_mappings[0]))
-
-bool gpad_device_button_pressed(const Gpad_Device_State* state, const Gpad_Button button) {
-    if(state && button < Gpad_Button_COUNT) {
-        return state->buttons & (1 << button);
-    }
-    return false;
-}
-
-const char* gpad_button_name(Gpad_Button button) {
-    switch(button) {
-        case Gpad_Button_A: return "A";
-        case Gpad_Button_B: return "B";
-        case Gpad_Button_X: return "X";
-        case Gpad_Button_Y: return "Y";
-        case Gpad_Button_Left_Shoulder: return "Left_Shoulder";
-        case Gpad_Button_Right_Shoulder: return "Right_Shoulder";
-        case Gpad_Button_Back: return "Back";
-        case Gpad_Button_Start: return "Start";
-        case Gpad_Button_Guide: return "Guide";
-        case Gpad_Button_Left_Thumb: return "Left_Thumb";
-        case Gpad_Button_Right_Thumb: return "Right_Thumb";
-        case Gpad_Button_Dpad_Up: return "Dpad_Up";
-        case Gpad_Button_Dpad_Right: return "Dpad_Right";
-        case Gpad_Button_Dpad_Down: return "Dpad_Down";
-        case Gpad_Button_Dpad_Left: return "Dpad_Left";
-    }
-    return "<Invalid>";
-}
-
-const char* gpad_axis_name(Gpad_Axis axis) {
-    switch(axis) {
-        case Gpad_Axis_Left_X: return "Left_X";
-        case Gpad_Axis_Left_Y: return "Left_Y";
-        case Gpad_Axis_Right_X: return "Right_X";
-        case Gpad_Axis_Right_Y: return "Right_Y";
-        case Gpad_Axis_Left_Trigger: return "Left_Trigger";
-        case Gpad_Axis_Right_Trigger: return "Right_Trigger";
-    }
-    return "<Invalid>";
-}
-
-// Returns -1 on failure.
-static int gpad__find_mapping(const char* guid) {
-    for(int i = 0; i < GPAD__NUM_MAPPINGS; i++) {
-        if(strncmp(guid, &g_gpad_mapping_guids[i][0], sizeof(Gpad_Guid)) == 0) {
-            return i;
-        }
-    }
-    return -1;
-}
-
-static const char* gpad__mapping_kind_name(Gpad_Mapping_Kind kind) {
-    switch(kind) {
-        case Gpad_Mapping_Kind_Axis: return "Axis";
-        case Gpad_Mapping_Kind_Button: return "Button";
-        case Gpad_Mapping_Kind_Hatbit: return "Hatbit";
-    }
-    return "<Invalid>";
-}
-
 #define GPAD__MAX_DINPUT_DEVICES 8
 
 typedef uint8_t Gpad_Device_Entry_Kind;
@@ -128,6 +39,10 @@ typedef struct Gpad_Device_Entry {
     };
 
     Gpad_Guid guid;
+    // DInput8 only, identical pads share the SDL GUID but not the instance GUID.
+    GUID instance_guid;
+    // DInput8 only, compiled on connect and when runtime mappings change.
+    Gpad_Compiled_Mapping mapping;
 } Gpad_Device_Entry;
 
 typedef struct Gpad_Context {
@@ -136,6 +51,9 @@ typedef struct Gpad_Context {
     HINSTANCE instance;
     Gpad_Device_Entry id_entries[GPAD_MAX_DEVICES];
     IDirectInput8* dinput8;
+
+    Gpad_Device_Callback device_callback;
+    void* device_callback_user_data;
 } Gpad_Context;
 
 static Gpad_Context gpad__context = {0};
@@ -154,6 +72,13 @@ static void gpad__remove_device_entry(const Gpad_Device_Id id) {
     }
 }
 
+static void gpad__disconnect_device(const Gpad_Device_Id id) {
+    gpad__remove_device_entry(id);
+    if(gpad__context.device_callback) {
+        gpad__context.device_callback(id, false, gpad__context.device_callback_user_data);
+    }
+}
+
 static Gpad_Device_Id gpad__find_unused_device_id(void) {
     for(int id = 0; id < GPAD_MAX_DEVICES; id++) {
         if(gpad__context.id_entries[id].mapping_index == GPAD_MAPPING_INDEX_INVALID) {
@@ -209,6 +134,25 @@ static bool gpad__supports_xinput(const GUID* guid) {
     return false;
 }
 
+// X, Y, Z, Rx, Ry, Rz and the two sliders, see gpad__dinput_raw_state.
+#define GPAD__DINPUT_NUM_AXES 8
+
+static void gpad__dinput_compile_mapping(Gpad_Device_Entry* entry) {
+    // DirectInput axes are in 0..65535.
+    Gpad_Axis_Calibration calibration[GPAD__MAX_RAW_AXES] = {0};
+    for(int i = 0; i < GPAD__DINPUT_NUM_AXES; i++) {
+        calibration[i].scale = 1.0f / 32767.5f;
+        calibration[i].bias = -1.0f;
+    }
+    gpad__compile_mapping(gpad__get_mapping(entry->mapping_index), calibration, &entry->mapping);
+}
+
+// Layout for devices with no database entry, raw indices as in gpad_poll_device. Xbox style, which most generic
+// DirectInput pads copy.
+#define GPAD__DINPUT_GENERIC_FIELDS                                                                                    \
+    "a:b0,b:b1,x:b2,y:b3,leftshoulder:b4,rightshoulder:b5,back:b6,start:b7,leftstick:b8,rightstick:b9,"                \
+    "dpup:h0.1,dpright:h0.2,dpdown:h0.4,dpleft:h0.8,leftx:a0,lefty:a1,lefttrigger:a2,rightx:a3,righty:a4,righttrigger:a5"
+
 static BOOL CALLBACK gpad__dinput_enum_devices_callback(LPCDIDEVICEINSTANCE device_instance, LPVOID userData) {
     IDirectInputDevice8* device = 0;
     IDirectInput8_CreateDevice(gpad__context.dinput8, &device_instance->guidInstance, &device, NULL);
@@ -230,38 +174,28 @@ static BOOL CALLBACK gpad__dinput_enum_devices_callback(LPCDIDEVICEINSTANCE devi
         return DIENUM_STOP;
     }
 
-    Gpad_Guid guid = "";
+    Gpad_Guid guid = {0};
 
     // Generate a joystick GUID that matches the SDL 2.0.5+ one
     if(memcmp(&device_instance->guidProduct.Data4[2], "PIDVID", 6) == 0) {
-        sprintf(
-            guid,
-            "03000000%02x%02x0000%02x%02x000000000000",
-            (uint8_t)(device_instance->guidProduct.Data1 >> 0),
-            (uint8_t)(device_instance->guidProduct.Data1 >> 8),
-            (uint8_t)(device_instance->guidProduct.Data1 >> 16),
-            (uint8_t)(device_instance->guidProduct.Data1 >> 24));
+        // 03000000VVVV0000PPPP000000000000
+        guid.data[0] = 0x03;
+        guid.data[4] = (uint8_t)(device_instance->guidProduct.Data1 >> 0);
+        guid.data[5] = (uint8_t)(device_instance->guidProduct.Data1 >> 8);
+        guid.data[8] = (uint8_t)(device_instance->guidProduct.Data1 >> 16);
+        guid.data[9] = (uint8_t)(device_instance->guidProduct.Data1 >> 24);
     } else {
-        sprintf(
-            guid,
-            "05000000%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x00",
-            name[0],
-            name[1],
-            name[2],
-            name[3],
-            name[4],
-            name[5],
-            name[6],
-            name[7],
-            name[8],
-            name[9],
-            name[10]);
+        // 05000000 followed by the first 11 bytes of the name
+        guid.data[0] = 0x05;
+        memcpy(&guid.data[4], name, 11);
     }
 
     Gpad_Device_Id id = GPAD_ID_INVALID;
 
     for(int i = 0; i < GPAD_MAX_DEVICES; i++) {
-        if(strncmp(guid, &gpad__context.id_entries[i].guid[0], sizeof(Gpad_Guid)) == 0) {
+        const Gpad_Device_Entry* other = &gpad__context.id_entries[i];
+        if(other->mapping_index != GPAD_MAPPING_INDEX_INVALID && other->kind == Gpad_Device_Entry_Kind_DInput8 &&
+           memcmp(&other->instance_guid, &device_instance->guidInstance, sizeof(GUID)) == 0) {
             id = i;
         }
     }
@@ -271,15 +205,27 @@ static BOOL CALLBACK gpad__dinput_enum_devices_callback(LPCDIDEVICEINSTANCE devi
     }
 
     if(id < GPAD_MAX_DEVICES) {
+        int mapping_index = gpad__resolve_mapping(&guid);
+        if(mapping_index < 0) {
+            mapping_index = gpad__add_generic_mapping(&guid, GPAD__DINPUT_GENERIC_FIELDS);
+        }
+        if(mapping_index < 0) {
+            IDirectInputDevice8_Release(device);
+            return DIENUM_CONTINUE;
+        }
+
         Gpad_Device_Entry entry = {0};
-        entry.mapping_index = gpad__find_mapping(&guid[0]);
+        entry.mapping_index = (Gpad_Mapping_Index)mapping_index;
         entry.kind = Gpad_Device_Entry_Kind_DInput8;
         entry.dinput8_device = device;
+        entry.guid = guid;
+        entry.instance_guid = device_instance->guidInstance;
+        gpad__dinput_compile_mapping(&entry);
 
         // {
-        //     Gpad_Mapping mapping = g_gpad_mappings[entry.mapping_index];
+        //     Gpad_Mapping mapping = *gpad__get_mapping(entry.mapping_index);
         //     printf("MAPPINGS:\n");
-        //     printf("\tname: %s\n", mapping.name);
+        //     printf("\tname: %s\n", gpad__mapping_name(entry.mapping_index));
         //     printf("\tbuttons:\n");
         //     for(int i = 0; i < Gpad_Button_COUNT; i++) {
         //         Gpad_Mapping_Elem elem = mapping.buttons[i];
@@ -339,12 +285,19 @@ bool gpad_initialize(void) {
         return false;
     }
 
+    gpad__load_env_mappings();
+
     gpad_refresh_connected_devices();
 
     gpad__context.initialized = true;
     return true;
 }
 
+bool gpad_initialize_backend(Gpad_Backend backend) {
+    if(backend != Gpad_Backend_Default) return false;
+    return gpad_initialize();
+}
+
 void gpad_shutdown(void) {
     if(!gpad__context.initialized)
         ;
@@ -352,6 +305,26 @@ void gpad_shutdown(void) {
     gpad__context.initialized = false;
 }
 
+void gpad_set_device_callback(Gpad_Device_Callback callback, void* user_data) {
+    gpad__context.device_callback = callback;
+    gpad__context.device_callback_user_data = user_data;
+}
+
+void gpad__rebind_devices(void) {
+    for(int id = 0; id < GPAD_MAX_DEVICES; id++) {
+        Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
+        if(entry->mapping_index == GPAD_MAPPING_INDEX_INVALID || entry->kind != Gpad_Device_Entry_Kind_DInput8) continue;
+
+        // Devices without a match keep their generic mapping.
+        const int mapping_index = gpad__resolve_mapping(&entry->guid);
+        if(mapping_index >= 0) {
+            entry->mapping_index = (Gpad_Mapping_Index)mapping_index;
+        }
+        // The mapping may also have been replaced in place.
+        gpad__dinput_compile_mapping(entry);
+    }
+}
+
 bool gpad_is_initialized(void) {
     return gpad__context.initialized;
 }
@@ -386,6 +359,17 @@ void gpad_refresh_connected_devices(void) {
     }
 }
 
+void gpad_pump(void) {
+    // Devices are polled directly in gpad_poll_device.
+}
+
+void gpad_get_stats(Gpad_Stats* out_stats) {
+    // Not tracked for DirectInput/XInput.
+    if(out_stats) {
+        memset(out_stats, 0, sizeof(Gpad_Stats));
+    }
+}
+
 int gpad_list_devices(Gpad_Device_Id* ids, const int ids_max) {
     if(!gpad__context.initialized) return 0;
     int num = 0;
@@ -401,19 +385,61 @@ int gpad_list_devices(Gpad_Device_Id* ids, const int ids_max) {
     return num;
 }
 
+
+// Raw state in the order the SDL DirectInput mappings index into.
+static void gpad__dinput_raw_state(const DIJOYSTATE* state, const DWORD num_povs, Gpad_Raw_State* out_raw) {
+    memset(out_raw, 0, sizeof(Gpad_Raw_State));
+
+    const LONG axes[GPAD__DINPUT_NUM_AXES] = {
+        state->lX,
+        state->lY,
+        state->lZ,
+        state->lRx,
+        state->lRy,
+        state->lRz,
+        state->rglSlider[0],
+        state->rglSlider[1],
+    };
+    for(int i = 0; i < GPAD__DINPUT_NUM_AXES; i++) {
+        out_raw->axes[i] = (int32_t)axes[i];
+    }
+
+    for(int i = 0; i < (int)sizeof(state->rgbButtons); i++) {
+        if(state->rgbButtons[i] & 0x80) {
+            out_raw->buttons |= (uint64_t)1 << i;
+        }
+    }
+
+    for(DWORD i = 0; i < num_povs && i < GPAD__MAX_RAW_HATS; i++) {
+        uint32_t pov_index = state->rgdwPOV[i] / 4500;
+        if(pov_index < 8) {
+            static const uint8_t states[8] = {
+                1,     // Up
+                2 | 1, // Right Up
+                2,     // Right
+                2 | 4, // Right Down
+                4,     // Down
+                8 | 4, // Left Down
+                8,     // Left
+                8 | 1, // Left Up
+            };
+            out_raw->hats[i] = states[pov_index];
+        }
+    }
+}
+
 bool gpad_poll_device(const Gpad_Device_Id id, Gpad_Device_State* out_state) {
     if(!gpad__context.initialized) return false;
     if(out_state == 0) return false;
 
-    Gpad_Device_Entry entry = gpad__context.id_entries[id];
+    const Gpad_Device_Entry* entry = &gpad__context.id_entries[id];
 
-    if(entry.mapping_index >= GPAD__NUM_MAPPINGS) return false;
+    if(entry->mapping_index >= GPAD__NUM_MAPPINGS) return false;
 
-    switch(entry.kind) {
+    switch(entry->kind) {
         case Gpad_Device_Entry_Kind_DInput8: {
-            IDirectInputDevice8* device = entry.dinput8_device;
+            IDirectInputDevice8* device = entry->dinput8_device;
             if(device) {
-                Gpad_Mapping mapping = g_gpad_mappings[entry.mapping_index];
                 DIJOYSTATE state;
 
                 IDirectInputDevice8_Poll(device);
@@ -428,7 +454,7 @@ bool gpad_poll_device(const Gpad_Device_Id id, Gpad_Device_State* out_state) {
 
                 if(error_code != DI_OK) {
                     // Failed
-                    gpad__remove_device_entry(id);
+                    gpad__disconnect_device(id);
                     return false;
                 }
 
@@ -450,112 +476,9 @@ bool gpad_poll_device(const Gpad_Device_Id id, Gpad_Device_State* out_state) {
                     // }
                     // printf("\n");
 
-                    Gpad_Device_State result;
-                    gpad__init_state(&result);
-
-                    const LONG axes[Gpad_Axis_COUNT] = {
-                        state.lX,  // Gpad_Axis_Left_X
-                        state.lY,  // Gpad_Axis_Left_Y
-                        state.lZ,  // Gpad_Axis_Left_Trigger
-                        state.lRx, // Gpad_Axis_Right_X
-                        state.lRy, // Gpad_Axis_Right_Y
-                        state.lRz, // Gpad_Axis_Right_Trigger
-                    };
-
-                    for(int i = 0; i < Gpad_Axis_COUNT; i++) {
-                        // printf("%i ", (int)axes[i]);
-                    }
-
-                    uint8_t hats[4] = {0};
-
-                    for(int i = 0; i < caps.dwPOVs; i++) {
-                        uint32_t pov_index = state.rgdwPOV[i] / 4500;
-                        if(pov_index < 8) {
-                            static const uint8_t states[8] = {
-                                1,     // Up
-                                2 | 1, // Right Up
-                                2,     // Right
-                                2 | 4, // Right Down
-                                4,     // Down
-                                8 | 4, // Left Down
-                                8,     // Left
-                                8 | 1, // Left Up
-                            };
-                            hats[i] = states[pov_index];
-                        }
-                    }
-
-                    for(int i = 0; i < Gpad_Button_COUNT; i++) {
-                        Gpad_Mapping_Elem elem = mapping.buttons[i];
-                        switch(elem.kind) {
-                            case Gpad_Mapping_Kind_Axis: {
-                                if(elem.axis_offset == 0 && elem.axis_scale == 0) continue;
-                                if(elem.index >= Gpad_Axis_COUNT) continue;
-
-                                const float fvalue = (((float)axes[elem.index] - 32768.0f) + 0.5f) / 32767.5f;
-
-                                // HACK: This should be baked into the value transform
-                                if(elem.axis_offset < 0 || (elem.axis_offset == 0 && elem.axis_scale > 0)) {
-                                    if(fvalue >= 0.0f) {
-                                        result.buttons |= 1 << i;
-                                    }
-                                } else {
-                                    if(fvalue <= 0.0f) {
-                                        result.buttons |= 1 << i;
-                                    }
-                                }
-                            } break;
-
-                            case Gpad_Mapping_Kind_Hatbit: {
-                                const unsigned int hat = elem.index >> 4;
-                                const unsigned int bit = elem.index & 0xf;
-                                if(hat < sizeof(hats) / sizeof(hats[0])) {
-                                    if(hats[hat] & bit) {
-                                        result.buttons |= 1 << i;
-                                    }
-                                }
-                            } break;
-
-                            case Gpad_Mapping_Kind_Button: {
-                                if(state.rgbButtons[elem.index] & 0x80) {
-                                    result.buttons |= 1 << i;
-                                }
-                            } break;
-                        }
-                    }
-
-                    for(int i = 0; i < Gpad_Axis_COUNT; i++) {
-                        Gpad_Mapping_Elem elem = mapping.axes[i];
-                        switch(elem.kind) {
-                            case Gpad_Mapping_Kind_Axis: {
-                                if(elem.axis_offset == 0 && elem.axis_scale == 0) continue;
-                                if(elem.index >= Gpad_Axis_COUNT) continue;
-
-                                result.axes[i] = (((float)axes[elem.index] - 32768.0f) + 0.5f) / 32767.5f;
-                                if(i == Gpad_Axis_Left_Y || i == Gpad_Axis_Right_Y) {
-                                    result.axes[i] *= -1.0f;
-                                }
-                            } break;
-
-                            case Gpad_Mapping_Kind_Hatbit: {
-                                const unsigned int hat = elem.index >> 4;
-                                const unsigned int bit = elem.index & 0xf;
-                                float val = -1.0f;
-                                if(hat < sizeof(hats) / sizeof(hats[0])) {
-                                    if(hats[hat] & bit) {
-                                        val = 1.0f;
-                                    }
-                                }
-                                result.axes[i] = val;
-                            } break;
-
-                            case Gpad_Mapping_Kind_Button: {
-                                result.axes[i] = state.rgbButtons[elem.index] & 0x80 ? GPAD_AXIS_MAX : GPAD_AXIS_MIN;
-                            } break;
-                        }
-                    }
-
-                    *out_state = result;
+                    Gpad_Raw_State raw;
+                    gpad__dinput_raw_state(&state, caps.dwPOVs, &raw);
+                    gpad__evaluate_mapping(&entry->mapping, &raw, out_state);
                     return true;
                 }
             }
@@ -564,13 +487,13 @@ bool gpad_poll_device(const Gpad_Device_Id id, Gpad_Device_State* out_state) {
 
 
         case Gpad_Device_Entry_Kind_XInput: {
-            if(entry.xinput_user_index < XUSER_MAX_COUNT) {
+            if(entry->xinput_user_index < XUSER_MAX_COUNT) {
                 XINPUT_STATE state = {0};
-                DWORD error_code = XInputGetState(entry.xinput_user_index, &state);
+                DWORD error_code = XInputGetState(entry->xinput_user_index, &state);
 
                 if(error_code != ERROR_SUCCESS) {
                     if(error_code == ERROR_DEVICE_NOT_CONNECTED) {
-                        gpad__remove_device_entry(id);
+                        gpad__disconnect_device(id);
                     }
                     return false;
                 }
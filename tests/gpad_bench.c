@@ -0,0 +1,287 @@
+// Benchmarks of the mapping code, built by build_linux.sh. Run from the gpad directory: ./tests/gpad_bench
+// Reads gamecontrollerdb.txt, or the file passed as the first argument.
+// Timings are the best of a few runs, to hide the noise of other processes.
+
+#include "../gpad.h"
+#include "../gpad_mapping.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_RUNS 5
+
+static double bench_now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+// Keeps the compiler from dropping the benchmarked work.
+static volatile float g_bench_sink;
+
+// The whole gamecontrollerdb.txt, for the benchmarks which need its text or GUIDs.
+static char* g_bench_db;
+static size_t g_bench_db_size;
+
+static bool bench_load_db(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if(!file) return false;
+    fseek(file, 0, SEEK_END);
+    g_bench_db_size = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    g_bench_db = (char*)malloc(g_bench_db_size);
+    const bool ok = g_bench_db && fread(g_bench_db, 1, g_bench_db_size, file) == g_bench_db_size;
+    fclose(file);
+    return ok;
+}
+
+static bool bench_ends_with(const char* str, const char* end, const char* suffix) {
+    const size_t len = strlen(suffix);
+    return (size_t)(end - str) >= len && memcmp(end - len, suffix, len) == 0;
+}
+
+static int bench_hex_digit(const char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return 0;
+}
+
+static void bench_calibration(Gpad_Axis_Calibration* out_calibration) {
+    for(int i = 0; i < GPAD__MAX_RAW_AXES; i++) {
+        out_calibration[i].scale = 1.0f / 32767.5f;
+        out_calibration[i].bias = 0.5f / 32767.5f;
+    }
+}
+
+// One gpad__evaluate_mapping call, cycling through every mapping of the database.
+static void bench_evaluate(void) {
+    enum { ITERATIONS = 1000000, MAX_MAPPINGS = 4096 };
+
+    Gpad_Axis_Calibration calibration[GPAD__MAX_RAW_AXES];
+    bench_calibration(calibration);
+
+    int num_mappings = gpad__mapping_count();
+    if(num_mappings > MAX_MAPPINGS) num_mappings = MAX_MAPPINGS;
+    static Gpad_Compiled_Mapping compiled[MAX_MAPPINGS];
+    for(int i = 0; i < num_mappings; i++) {
+        gpad__compile_mapping(gpad__get_mapping((Gpad_Mapping_Index)i), calibration, &compiled[i]);
+    }
+
+    Gpad_Raw_State raw = {0};
+    raw.buttons = 0x5555;
+    raw.hats[0] = 3;
+
+    double best = 1e30;
+    for(int run = 0; run < BENCH_RUNS; run++) {
+        const double start = bench_now();
+        for(int i = 0; i < ITERATIONS; i++) {
+            raw.axes[i & (GPAD__MAX_RAW_AXES - 1)] = i & 0x7fff;
+            Gpad_Device_State state;
+            gpad__evaluate_mapping(&compiled[i % num_mappings], &raw, &state);
+            g_bench_sink += state.axes[0] + state.buttons;
+        }
+        const double time = (bench_now() - start) / ITERATIONS;
+        if(time < best) best = time;
+    }
+    printf("evaluate mapping: %.1f ns\n", best);
+}
+
+// Refreshing 8 devices against the full Linux table. Once through the perfect hash of gpad__resolve_mapping,
+// and once with the strncmp scan over the GUID strings that gpad__find_mapping did before it.
+static void bench_resolve(void) {
+    enum { NUM_DEVICES = 8, ITERATIONS = 100000, MAX_GUIDS = 4096 };
+
+    static char guid_strings[MAX_GUIDS][33];
+    int num_guids = 0;
+    const char* end = g_bench_db + g_bench_db_size;
+    for(const char* line = g_bench_db; line < end && num_guids < MAX_GUIDS;) {
+        const char* line_end = (const char*)memchr(line, '\n', end - line);
+        if(!line_end) line_end = end;
+        const char* content_end = line_end > line && line_end[-1] == '\r' ? line_end - 1 : line_end;
+
+        const bool linux_line = bench_ends_with(line, content_end, "platform:Linux,") ||
+                                bench_ends_with(line, content_end, "platform:Linux");
+        if(linux_line && content_end - line > 33 && line[32] == ',') {
+            memcpy(guid_strings[num_guids], line, 32);
+            guid_strings[num_guids][32] = 0;
+            num_guids++;
+        }
+        line = line_end + 1;
+    }
+    if(num_guids == 0) return;
+
+    // Spread over the table, the scan finds them halfway on average.
+    const char* device_strings[NUM_DEVICES];
+    Gpad_Guid devices[NUM_DEVICES];
+    for(int i = 0; i < NUM_DEVICES; i++) {
+        device_strings[i] = guid_strings[(2 * i + 1) * num_guids / (2 * NUM_DEVICES)];
+        for(int j = 0; j < 16; j++) {
+            const int hi = bench_hex_digit(device_strings[i][j * 2]);
+            const int lo = bench_hex_digit(device_strings[i][j * 2 + 1]);
+            devices[i].data[j] = (uint8_t)((hi << 4) | lo);
+        }
+    }
+
+    double best_hash = 1e30;
+    double best_scan = 1e30;
+    for(int run = 0; run < BENCH_RUNS; run++) {
+        double start = bench_now();
+        for(int i = 0; i < ITERATIONS; i++) {
+            for(int device = 0; device < NUM_DEVICES; device++) {
+                g_bench_sink += (float)gpad__resolve_mapping(&devices[device]);
+            }
+        }
+        double time = (bench_now() - start) / ITERATIONS;
+        if(time < best_hash) best_hash = time;
+
+        start = bench_now();
+        for(int i = 0; i < ITERATIONS / 100; i++) {
+            for(int device = 0; device < NUM_DEVICES; device++) {
+                int found = -1;
+                for(int row = 0; row < num_guids; row++) {
+                    if(strncmp(guid_strings[row], device_strings[device], 32) == 0) {
+                        found = row;
+                        break;
+                    }
+                }
+                g_bench_sink += (float)found;
+            }
+        }
+        time = (bench_now() - start) / (ITERATIONS / 100);
+        if(time < best_scan) best_scan = time;
+    }
+    printf("resolve %i devices: %.1f ns perfect hash, %.1f ns linear scan over %i GUIDs\n",
+        NUM_DEVICES, best_hash, best_scan, num_guids);
+}
+
+// Parsing the whole gamecontrollerdb.txt, from memory and through the file loader.
+// Lines for other platforms are part of it, they are skipped.
+static void bench_parse(const char* path) {
+    enum { ITERATIONS = 20 };
+
+    double best_memory = 1e30;
+    double best_file = 1e30;
+    int count = 0;
+    for(int run = 0; run < BENCH_RUNS; run++) {
+        // Loading the same GUIDs again replaces the mappings in place, so the runtime storage doesn't fill up.
+        double start = bench_now();
+        for(int i = 0; i < ITERATIONS; i++) {
+            count = gpad_load_mappings_from_memory(g_bench_db, g_bench_db_size);
+        }
+        double time = (bench_now() - start) / ITERATIONS;
+        if(time < best_memory) best_memory = time;
+
+        start = bench_now();
+        for(int i = 0; i < ITERATIONS; i++) {
+            gpad_load_mappings_from_file(path);
+        }
+        time = (bench_now() - start) / ITERATIONS;
+        if(time < best_file) best_file = time;
+    }
+    printf("parse %i mappings: %.3f ms from memory, %.3f ms from file\n", count, best_memory / 1e6, best_file / 1e6);
+}
+
+// gpad__evaluate_mapping for every changed device against gpad__evaluate_mappings, with all devices changed and with
+// only one changed like in a typical gpad_pump. build_linux.sh builds this with GPAD_MAX_DEVICES 255, larger counts
+// are skipped. Build with -DGPAD_NO_SIMD or -mavx2 to compare the kernels.
+static void bench_batch(void) {
+    enum { ITERATIONS = 20000 };
+    const int device_counts[] = {8, 64, 255};
+
+    Gpad_Axis_Calibration calibration[GPAD__MAX_RAW_AXES];
+    bench_calibration(calibration);
+
+    static Gpad_Compiled_Mapping mappings[GPAD_MAX_DEVICES];
+    static Gpad_Raw_State raws[GPAD_MAX_DEVICES];
+    static Gpad_Device_State states[GPAD_MAX_DEVICES];
+    static Gpad_Axis_Batch batch;
+    const Gpad_Compiled_Mapping* compiled[GPAD_MAX_DEVICES];
+    const Gpad_Raw_State* raw[GPAD_MAX_DEVICES];
+    Gpad_Device_State* out_states[GPAD_MAX_DEVICES];
+    bool changed[GPAD_MAX_DEVICES];
+
+    const int num_mappings = gpad__mapping_count();
+    for(int device = 0; device < GPAD_MAX_DEVICES; device++) {
+        const Gpad_Mapping_Index index = (Gpad_Mapping_Index)(device * 7 % num_mappings);
+        gpad__compile_mapping(gpad__get_mapping(index), calibration, &mappings[device]);
+        for(int i = 0; i < GPAD__MAX_RAW_AXES; i++) {
+            raws[device].axes[i] = (device * 31 + i * 1021) % 65536 - 32768;
+        }
+        raws[device].buttons = 0x5555u << (device % 8);
+        raws[device].hats[0] = (uint8_t)(device & 0xf);
+        compiled[device] = &mappings[device];
+        raw[device] = &raws[device];
+        out_states[device] = &states[device];
+        changed[device] = device == 0;
+    }
+
+    for(int c = 0; c < (int)(sizeof(device_counts) / sizeof(device_counts[0])); c++) {
+        const int num_devices = device_counts[c];
+        if(num_devices > GPAD_MAX_DEVICES) continue;
+        gpad__build_axis_batch(&batch, compiled, num_devices);
+
+        double best_single = 1e30;
+        double best_batch = 1e30;
+        double best_one_changed_single = 1e30;
+        double best_one_changed = 1e30;
+        for(int run = 0; run < BENCH_RUNS; run++) {
+            double start = bench_now();
+            for(int i = 0; i < ITERATIONS; i++) {
+                for(int device = 0; device < num_devices; device++) {
+                    gpad__evaluate_mapping(compiled[device], raw[device], out_states[device]);
+                }
+                g_bench_sink += states[i % num_devices].axes[0];
+            }
+            double time = (bench_now() - start) / ITERATIONS;
+            if(time < best_single) best_single = time;
+
+            start = bench_now();
+            for(int i = 0; i < ITERATIONS; i++) {
+                gpad__evaluate_mappings(&batch, compiled, raw, out_states, NULL, num_devices);
+                g_bench_sink += states[i % num_devices].axes[0];
+            }
+            time = (bench_now() - start) / ITERATIONS;
+            if(time < best_batch) best_batch = time;
+
+            start = bench_now();
+            for(int i = 0; i < ITERATIONS; i++) {
+                for(int device = 0; device < num_devices; device++) {
+                    if(!changed[device]) continue;
+                    gpad__evaluate_mapping(compiled[device], raw[device], out_states[device]);
+                }
+                g_bench_sink += states[0].axes[0];
+            }
+            time = (bench_now() - start) / ITERATIONS;
+            if(time < best_one_changed_single) best_one_changed_single = time;
+
+            start = bench_now();
+            for(int i = 0; i < ITERATIONS; i++) {
+                gpad__evaluate_mappings(&batch, compiled, raw, out_states, changed, num_devices);
+                g_bench_sink += states[0].axes[0];
+            }
+            time = (bench_now() - start) / ITERATIONS;
+            if(time < best_one_changed) best_one_changed = time;
+        }
+        printf("evaluate %i devices, all changed: %.0f ns one by one, %.0f ns batched\n",
+            num_devices, best_single, best_batch);
+        printf("evaluate %i devices, one changed: %.0f ns one by one, %.0f ns batched\n",
+            num_devices, best_one_changed_single, best_one_changed);
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* db_path = argc > 1 ? argv[1] : "gamecontrollerdb.txt";
+    if(!bench_load_db(db_path)) {
+        printf("Couldn't read %s\n", db_path);
+        return 1;
+    }
+
+    bench_evaluate();
+    bench_resolve();
+    bench_batch();
+    // Adds runtime mappings, so after the others.
+    bench_parse(db_path);
+    return 0;
+}
@@ -0,0 +1,407 @@
+// Tests of the Linux backend against a virtual gamepad, built and run by build_linux.sh.
+//
+// Creates a pad through /dev/uinput and checks hotplug, input, batched reads, the resync after SYN_DROPPED, rebinding
+// to an added mapping, rumble, reopening on gpad_initialize and the disconnect. Needs write access to /dev/uinput,
+// usually root or the input group, and is skipped without it.
+
+#include "../gpad.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/uinput.h>
+
+// Not in the database, so the pad gets the generic mapping made from its evdev codes.
+#define TEST_VENDOR 0x1209
+#define TEST_PRODUCT 0xfad0
+
+#define TEST_TIMEOUT_MS 2000
+#define TEST_AXIS_EPSILON 1e-3f
+
+static int g_test_checks = 0;
+static int g_test_failures = 0;
+
+static void test_check(const bool ok, const char* what) {
+    g_test_checks++;
+    if(ok) return;
+    printf("FAIL: %s\n", what);
+    g_test_failures++;
+}
+
+static bool test_near(const float value, const float expected) {
+    return fabsf(value - expected) < TEST_AXIS_EPSILON;
+}
+
+static void test_sleep_ms(const int ms) {
+    struct timespec time = {0, ms * 1000000L};
+    nanosleep(&time, 0);
+}
+
+//
+// The virtual pad
+//
+
+static int g_uinput_fd = -1;
+
+static const int g_test_keys[] = {
+    BTN_SOUTH, BTN_EAST, BTN_NORTH, BTN_WEST, BTN_TL, BTN_TR,
+    BTN_SELECT, BTN_START, BTN_MODE, BTN_THUMBL, BTN_THUMBR,
+};
+
+static void test_abs_setup(const int code, const int minimum, const int maximum) {
+    struct uinput_abs_setup setup = {0};
+    setup.code = (uint16_t)code;
+    setup.absinfo.minimum = minimum;
+    setup.absinfo.maximum = maximum;
+    setup.absinfo.value = (minimum + maximum) / 2;
+    ioctl(g_uinput_fd, UI_ABS_SETUP, &setup);
+}
+
+// Like an Xbox pad: sticks on X/Y and RX/RY, triggers on Z/RZ and the dpad on a hat.
+static bool test_create_pad(void) {
+    ioctl(g_uinput_fd, UI_SET_EVBIT, EV_KEY);
+    ioctl(g_uinput_fd, UI_SET_EVBIT, EV_ABS);
+    ioctl(g_uinput_fd, UI_SET_EVBIT, EV_FF);
+    for(int i = 0; i < (int)(sizeof(g_test_keys) / sizeof(g_test_keys[0])); i++) {
+        ioctl(g_uinput_fd, UI_SET_KEYBIT, g_test_keys[i]);
+    }
+    const int axes[] = {ABS_X, ABS_Y, ABS_Z, ABS_RX, ABS_RY, ABS_RZ, ABS_HAT0X, ABS_HAT0Y};
+    for(int i = 0; i < (int)(sizeof(axes) / sizeof(axes[0])); i++) {
+        ioctl(g_uinput_fd, UI_SET_ABSBIT, axes[i]);
+    }
+    ioctl(g_uinput_fd, UI_SET_FFBIT, FF_RUMBLE);
+
+    struct uinput_setup setup = {0};
+    setup.id.bustype = BUS_USB;
+    setup.id.vendor = TEST_VENDOR;
+    setup.id.product = TEST_PRODUCT;
+    setup.ff_effects_max = 1;
+    snprintf(setup.name, sizeof(setup.name), "gpad test pad");
+    if(ioctl(g_uinput_fd, UI_DEV_SETUP, &setup) < 0) return false;
+
+    test_abs_setup(ABS_X, -32768, 32767);
+    test_abs_setup(ABS_Y, -32768, 32767);
+    test_abs_setup(ABS_RX, -32768, 32767);
+    test_abs_setup(ABS_RY, -32768, 32767);
+    test_abs_setup(ABS_Z, 0, 255);
+    test_abs_setup(ABS_RZ, 0, 255);
+    test_abs_setup(ABS_HAT0X, -1, 1);
+    test_abs_setup(ABS_HAT0Y, -1, 1);
+
+    return ioctl(g_uinput_fd, UI_DEV_CREATE) >= 0;
+}
+
+static void test_emit(const int type, const int code, const int value) {
+    struct input_event event = {0};
+    event.type = (uint16_t)type;
+    event.code = (uint16_t)code;
+    event.value = value;
+    if(write(g_uinput_fd, &event, sizeof(event)) != (ssize_t)sizeof(event)) {
+        printf("uinput write failed: %s\n", strerror(errno));
+    }
+}
+
+static void test_sync(void) {
+    test_emit(EV_SYN, SYN_REPORT, 0);
+}
+
+//
+// Force feedback requests, uinput passes them to the process which created the pad.
+// EVIOCSFF in gpad_rumble_device waits for the answer, so they are handled on a separate thread.
+//
+
+static pthread_t g_ff_thread;
+static int g_ff_stop;
+static int g_ff_uploads;
+static int g_ff_strong;
+static int g_ff_weak;
+// Value of the last EV_FF play event, -1 before the first one.
+static int g_ff_playing = -1;
+
+static void* test_ff_thread(void* arg) {
+    (void)arg;
+    while(!__atomic_load_n(&g_ff_stop, __ATOMIC_ACQUIRE)) {
+        struct pollfd pollfd = {g_uinput_fd, POLLIN, 0};
+        if(poll(&pollfd, 1, 10) <= 0) continue;
+
+        struct input_event event;
+        if(read(g_uinput_fd, &event, sizeof(event)) != (ssize_t)sizeof(event)) continue;
+
+        if(event.type == EV_UINPUT && event.code == UI_FF_UPLOAD) {
+            struct uinput_ff_upload upload = {0};
+            upload.request_id = (uint32_t)event.value;
+            if(ioctl(g_uinput_fd, UI_BEGIN_FF_UPLOAD, &upload) < 0) continue;
+            __atomic_store_n(&g_ff_strong, upload.effect.u.rumble.strong_magnitude, __ATOMIC_RELEASE);
+            __atomic_store_n(&g_ff_weak, upload.effect.u.rumble.weak_magnitude, __ATOMIC_RELEASE);
+            __atomic_add_fetch(&g_ff_uploads, 1, __ATOMIC_ACQ_REL);
+            upload.retval = 0;
+            ioctl(g_uinput_fd, UI_END_FF_UPLOAD, &upload);
+        } else if(event.type == EV_UINPUT && event.code == UI_FF_ERASE) {
+            struct uinput_ff_erase erase = {0};
+            erase.request_id = (uint32_t)event.value;
+            if(ioctl(g_uinput_fd, UI_BEGIN_FF_ERASE, &erase) < 0) continue;
+            erase.retval = 0;
+            ioctl(g_uinput_fd, UI_END_FF_ERASE, &erase);
+        } else if(event.type == EV_FF) {
+            __atomic_store_n(&g_ff_playing, event.value, __ATOMIC_RELEASE);
+        }
+    }
+    return 0;
+}
+
+//
+// gpad side
+//
+
+static Gpad_Device_Id g_test_connected = GPAD_ID_INVALID;
+static Gpad_Device_Id g_test_disconnected = GPAD_ID_INVALID;
+static Gpad_Device_Id g_test_id = GPAD_ID_INVALID;
+static Gpad_Device_State g_test_state;
+
+static void test_on_device(const Gpad_Device_Id id, const bool connected, void* user_data) {
+    (void)user_data;
+    if(connected) {
+        g_test_connected = id;
+    } else {
+        g_test_disconnected = id;
+    }
+}
+
+// Pumps until done returns true, the kernel and gpad don't see the uinput writes at the same time.
+static bool test_wait(bool (*done)(void)) {
+    for(int ms = 0; ms < TEST_TIMEOUT_MS; ms++) {
+        gpad_pump();
+        gpad_poll_device(g_test_id, &g_test_state);
+        if(done()) return true;
+        test_sleep_ms(1);
+    }
+    return false;
+}
+
+static bool test_connected(void) {
+    return g_test_connected != GPAD_ID_INVALID;
+}
+
+static bool test_disconnected(void) {
+    return g_test_disconnected == g_test_id;
+}
+
+static bool test_a_pressed(void) {
+    return gpad_device_button_pressed(&g_test_state, Gpad_Button_A);
+}
+
+static bool test_a_released(void) {
+    return !gpad_device_button_pressed(&g_test_state, Gpad_Button_A);
+}
+
+static bool test_left_x_max(void) {
+    return test_near(g_test_state.axes[Gpad_Axis_Left_X], 1.0f);
+}
+
+static bool test_right_x_min(void) {
+    return test_near(g_test_state.axes[Gpad_Axis_Right_X], -1.0f);
+}
+
+static bool test_right_y_down(void) {
+    return test_near(g_test_state.axes[Gpad_Axis_Right_Y], -1.0f);
+}
+
+static bool test_b_pressed(void) {
+    return gpad_device_button_pressed(&g_test_state, Gpad_Button_B);
+}
+
+static bool test_b_released(void) {
+    return !gpad_device_button_pressed(&g_test_state, Gpad_Button_B);
+}
+
+static bool test_ff_playing(void) {
+    return __atomic_load_n(&g_ff_playing, __ATOMIC_ACQUIRE) == 1;
+}
+
+static bool test_ff_stopped(void) {
+    return __atomic_load_n(&g_ff_playing, __ATOMIC_ACQUIRE) == 0;
+}
+
+static void test_input(void) {
+    test_emit(EV_KEY, BTN_SOUTH, 1);
+    test_emit(EV_KEY, BTN_START, 1);
+    test_sync();
+    test_check(test_wait(test_a_pressed), "A pressed");
+    test_check(gpad_device_button_pressed(&g_test_state, Gpad_Button_Start), "Start pressed");
+    test_check(!gpad_device_button_pressed(&g_test_state, Gpad_Button_B), "B released");
+
+    test_emit(EV_KEY, BTN_SOUTH, 0);
+    test_emit(EV_KEY, BTN_START, 0);
+    test_sync();
+    test_check(test_wait(test_a_released), "A released");
+    test_check(!gpad_device_button_pressed(&g_test_state, Gpad_Button_Start), "Start released");
+
+    // Down on the pad is negative Y in gpad. Triggers go from -1 released to 1.
+    test_emit(EV_ABS, ABS_X, 32767);
+    test_emit(EV_ABS, ABS_Y, 32767);
+    test_emit(EV_ABS, ABS_Z, 255);
+    test_emit(EV_ABS, ABS_RZ, 0);
+    test_emit(EV_ABS, ABS_HAT0Y, -1);
+    test_sync();
+    test_check(test_wait(test_left_x_max), "Left_X at 1");
+    test_check(test_near(g_test_state.axes[Gpad_Axis_Left_Y], -1.0f), "Left_Y at -1");
+    test_check(test_near(g_test_state.axes[Gpad_Axis_Left_Trigger], 1.0f), "Left_Trigger at 1");
+    test_check(test_near(g_test_state.axes[Gpad_Axis_Right_Trigger], -1.0f), "Right_Trigger at -1");
+    test_check(gpad_device_button_pressed(&g_test_state, Gpad_Button_Dpad_Up), "Dpad_Up pressed");
+    test_check(!gpad_device_button_pressed(&g_test_state, Gpad_Button_Dpad_Down), "Dpad_Down released");
+}
+
+// Frames queued since the last pump are read together, not with a syscall each.
+static void test_batched_reads(void) {
+    enum { FRAMES = 10 };
+
+    Gpad_Stats before;
+    gpad_get_stats(&before);
+    for(int i = 0; i < FRAMES; i++) {
+        // The kernel drops values which didn't change, so none of them is the 0 the axis starts at.
+        test_emit(EV_ABS, ABS_RX, i == FRAMES - 1 ? -32768 : (i + 1) * 1000);
+        test_sync();
+    }
+    test_check(test_wait(test_right_x_min), "Right_X after batched frames");
+
+    Gpad_Stats after;
+    gpad_get_stats(&after);
+    test_check(after.events_read - before.events_read == FRAMES * 2, "every batched event read");
+#ifndef GPAD_IO_URING
+    // io_uring completes a read as soon as the first frame arrives, epoll drains the queue in one go.
+    test_check(after.read_calls - before.read_calls <= 2, "batched frames in one read");
+#endif
+}
+
+// Far more frames than the evdev client buffer holds. The kernel drops them and reports SYN_DROPPED,
+// gpad then has to ask the device for its state instead of trusting the events.
+static void test_syn_dropped(void) {
+    enum { FRAMES = 4096 };
+
+    for(int i = 0; i < FRAMES; i++) {
+        test_emit(EV_ABS, ABS_RY, i % 2 ? -20000 : 20000);
+        if(i == FRAMES / 2) test_emit(EV_KEY, BTN_EAST, 1);
+        test_sync();
+    }
+    test_emit(EV_ABS, ABS_RY, 32767);
+    test_sync();
+
+    test_check(test_wait(test_right_y_down), "Right_Y after an overflow");
+    test_check(gpad_device_button_pressed(&g_test_state, Gpad_Button_B), "B pressed after an overflow");
+
+    test_emit(EV_KEY, BTN_EAST, 0);
+    test_sync();
+}
+
+// A mapping added for the pad switches it over right away. The GUID of the line has no name CRC, so it's found by
+// the fallback without it.
+static void test_rebind(void) {
+    test_check(gpad_add_mapping("0300000009120000d0fa000000000000,gpad test pad swapped,a:b1,b:b0"), "swapped mapping");
+    test_emit(EV_KEY, BTN_SOUTH, 1);
+    test_sync();
+    test_check(test_wait(test_b_pressed), "rebound BTN_SOUTH is B");
+    test_check(!gpad_device_button_pressed(&g_test_state, Gpad_Button_A), "rebound BTN_SOUTH isn't A");
+    test_emit(EV_KEY, BTN_SOUTH, 0);
+    test_sync();
+    test_check(test_wait(test_b_released), "rebound BTN_SOUTH released");
+
+    // Back to the generic layout for the rest.
+    test_check(gpad_add_mapping("0300000009120000d0fa000000000000,gpad test pad,a:b0,b:b1"), "restored mapping");
+    test_emit(EV_KEY, BTN_SOUTH, 1);
+    test_sync();
+    test_check(test_wait(test_a_pressed), "restored BTN_SOUTH is A");
+    test_emit(EV_KEY, BTN_SOUTH, 0);
+    test_sync();
+    test_check(test_wait(test_a_released), "restored BTN_SOUTH released");
+}
+
+static void test_rumble(void) {
+    test_check(gpad_rumble_device(g_test_id, 0.5f, 0.25f), "rumble started");
+    test_check(__atomic_load_n(&g_ff_uploads, __ATOMIC_ACQUIRE) == 1, "rumble effect uploaded");
+    test_check(__atomic_load_n(&g_ff_strong, __ATOMIC_ACQUIRE) == (int)(0.5f * 65535.0f), "rumble strong magnitude");
+    test_check(__atomic_load_n(&g_ff_weak, __ATOMIC_ACQUIRE) == (int)(0.25f * 65535.0f), "rumble weak magnitude");
+    test_check(test_wait(test_ff_playing), "rumble playing");
+
+    // The same values again are skipped.
+    test_check(gpad_rumble_device(g_test_id, 0.5f, 0.25f), "rumble repeated");
+    test_check(__atomic_load_n(&g_ff_uploads, __ATOMIC_ACQUIRE) == 1, "repeated rumble not uploaded");
+
+    test_check(gpad_rumble_device(g_test_id, 0.0f, 0.0f), "rumble stopped");
+    test_check(test_wait(test_ff_stopped), "rumble not playing");
+}
+
+int main(void) {
+    g_uinput_fd = open("/dev/uinput", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if(g_uinput_fd < 0) {
+        printf("Skipped, /dev/uinput isn't accessible: %s\n", strerror(errno));
+        return 0;
+    }
+
+    gpad_set_device_callback(test_on_device, 0);
+    test_check(gpad_initialize(), "gpad_initialize");
+    g_test_connected = GPAD_ID_INVALID;
+
+    // Found by the /dev/input watch in gpad_pump, without a refresh.
+    if(!test_create_pad()) {
+        printf("Skipped, couldn't create the uinput device: %s\n", strerror(errno));
+        gpad_shutdown();
+        close(g_uinput_fd);
+        return 0;
+    }
+    pthread_create(&g_ff_thread, 0, test_ff_thread, 0);
+
+    const bool hotplugged = test_wait(test_connected);
+    test_check(hotplugged, "hotplug connect callback");
+    if(!hotplugged) {
+        // Without inotify the rest can still run.
+        gpad_refresh_connected_devices();
+    }
+    g_test_id = g_test_connected;
+    test_check(gpad_device_valid(g_test_id), "connected device valid");
+
+    if(gpad_device_valid(g_test_id)) {
+        test_input();
+        test_batched_reads();
+        test_syn_dropped();
+        test_rebind();
+        test_rumble();
+    }
+
+    // Opened again with the rest on gpad_initialize, it has to report the current state right away.
+    gpad_shutdown();
+    test_emit(EV_KEY, BTN_SOUTH, 1);
+    test_sync();
+    g_test_connected = GPAD_ID_INVALID;
+    g_test_id = GPAD_ID_INVALID;
+    test_check(gpad_initialize(), "gpad_initialize again");
+
+    Gpad_Device_Id ids[GPAD_MAX_DEVICES];
+    const int num_ids = gpad_list_devices(ids, GPAD_MAX_DEVICES);
+    for(int i = 0; i < num_ids; i++) {
+        Gpad_Device_State state;
+        if(gpad_poll_device(ids[i], &state) && gpad_device_button_pressed(&state, Gpad_Button_A)) {
+            g_test_id = ids[i];
+        }
+    }
+    test_check(g_test_id != GPAD_ID_INVALID, "device reopened with its state");
+    test_check(g_test_connected != GPAD_ID_INVALID, "connect callback on gpad_initialize");
+
+    ioctl(g_uinput_fd, UI_DEV_DESTROY);
+    test_check(test_wait(test_disconnected), "disconnect callback");
+    test_check(!gpad_device_valid(g_test_id), "disconnected device invalid");
+
+    gpad_shutdown();
+    __atomic_store_n(&g_ff_stop, 1, __ATOMIC_RELEASE);
+    pthread_join(g_ff_thread, 0);
+    close(g_uinput_fd);
+
+    printf("%i checks, %i failed\n", g_test_checks, g_test_failures);
+    return g_test_failures ? 1 : 0;
+}
@@ -0,0 +1,676 @@
+// Tests of the mapping evaluation, built and run by build_linux.sh. Once more against a build_db --compress database.
+//
+// Every mapping of the built-in database is compiled and evaluated on a table of raw states, and compared to a
+// reference which follows the SDL rules directly on the Gpad_Mapping elements. After that the GUID fallbacks of
+// gpad__resolve_mapping are checked, the database file build_db wrote is loaded along with damaged copies of it,
+// runtime mappings are loaded over the database, and a few hand written mappings are checked against exact
+// expected values.
+
+#include "../gpad.h"
+#include "../gpad_mapping.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Axes are calibrated like evdev axes with a [-32768, 32767] range, so raw values are in SDL units.
+#define TEST_AXIS_SCALE (1.0f / 32767.5f)
+#define TEST_AXIS_BIAS (0.5f / 32767.5f)
+// Allowed difference to the reference, SDL rescales with integers.
+#define TEST_AXIS_EPSILON 2e-3f
+
+static const int32_t g_test_axis_values[] = {
+    -32768, -32767, -24576, -17000, -16000, -8192, -1, 0, 1, 8192, 16000, 17000, 24576, 32766, 32767,
+};
+
+static const uint64_t g_test_button_values[] = {
+    0,
+    ~0ull,
+    0x5555555555555555ull,
+    0xaaaaaaaaaaaaaaaaull,
+    0x0123456789abcdefull,
+};
+
+#define TEST_CASES_PER_MAPPING 64
+
+static int g_test_checks = 0;
+static int g_test_failures = 0;
+
+static void test_check(
+    const bool ok, const char* mapping_name, const char* what, const char* output, const int test_case) {
+    g_test_checks++;
+    if(ok) return;
+    if(g_test_failures < 20) {
+        printf("FAIL: %s, %s %s, case %i\n", mapping_name, what, output, test_case);
+    }
+    g_test_failures++;
+}
+
+// Raw state number test_case, cycles through the tables with a different phase for every input.
+static void test_raw_state(const int test_case, Gpad_Raw_State* out_raw) {
+    const int num_axis_values = (int)(sizeof(g_test_axis_values) / sizeof(g_test_axis_values[0]));
+    const int num_button_values = (int)(sizeof(g_test_button_values) / sizeof(g_test_button_values[0]));
+
+    memset(out_raw, 0, sizeof(Gpad_Raw_State));
+    const uint64_t buttons = g_test_button_values[test_case % num_button_values];
+    const int rotate = test_case % 64;
+    out_raw->buttons = rotate ? buttons << rotate | buttons >> (64 - rotate) : buttons;
+    for(int i = 0; i < GPAD__MAX_RAW_AXES; i++) {
+        out_raw->axes[i] = g_test_axis_values[(test_case + i * 7) % num_axis_values];
+    }
+    for(int i = 0; i < GPAD__MAX_RAW_HATS; i++) {
+        out_raw->hats[i] = (uint8_t)((test_case + i * 5) & 0xf);
+    }
+}
+
+//
+// Reference, SDL semantics without any of the precomputation.
+//
+
+// SDL input range of an axis element, from the "+", "-" and "~" modifiers the parser encoded into scale and offset.
+static void ref_axis_range(const Gpad_Mapping_Elem elem, int* out_min, int* out_max) {
+    int scale = elem.axis_scale;
+    int offset = elem.axis_offset;
+    const bool inverted = scale < 0;
+    if(inverted) {
+        scale = -scale;
+        offset = -offset;
+    }
+
+    if(scale == 1) {
+        *out_min = -32768;
+        *out_max = 32767;
+    } else if(offset < 0) {
+        *out_min = 0;
+        *out_max = 32767;
+    } else {
+        *out_min = 0;
+        *out_max = -32768;
+    }
+
+    if(inverted) {
+        const int temp = *out_min;
+        *out_min = *out_max;
+        *out_max = temp;
+    }
+}
+
+static bool ref_in_range(const int value, const int min, const int max) {
+    return min < max ? value >= min && value <= max : value >= max && value <= min;
+}
+
+static bool ref_axis_mapped(const Gpad_Mapping_Elem elem) {
+    return elem.kind == Gpad_Mapping_Kind_Axis && elem.axis_scale != 0 && elem.index < GPAD__MAX_RAW_AXES;
+}
+
+// Buttons and hat bits, false for anything out of the raw state.
+static bool ref_digital_pressed(const Gpad_Mapping_Elem elem, const Gpad_Raw_State* raw) {
+    switch(elem.kind) {
+        case Gpad_Mapping_Kind_Button: {
+            return elem.index < GPAD__MAX_RAW_BUTTONS && ((raw->buttons >> elem.index) & 1);
+        }
+
+        case Gpad_Mapping_Kind_Hatbit: {
+            const int hat = elem.index >> 4;
+            return hat < GPAD__MAX_RAW_HATS && (raw->hats[hat] & elem.index & 0xf);
+        }
+    }
+    return false;
+}
+
+// SDL rescales the input range to the output range, values outside the input range are ignored.
+static bool ref_axis_value(
+    const Gpad_Mapping_Elem elem,
+    const Gpad_Raw_State* raw,
+    const int output_min,
+    const int output_max,
+    int* out_value) {
+    int min, max;
+    ref_axis_range(elem, &min, &max);
+    int value = raw->axes[elem.index];
+    if(!ref_in_range(value, min, max)) return false;
+
+    if(min != output_min || max != output_max) {
+        const float t = (float)(value - min) / (float)(max - min);
+        value = output_min + (int)(t * (float)(output_max - output_min));
+    }
+    *out_value = value;
+    return true;
+}
+
+// Returns false when the result depends on rounding, right at the threshold.
+static bool ref_button(const Gpad_Mapping_Elem elem, const Gpad_Raw_State* raw, bool* out_pressed) {
+    if(elem.kind != Gpad_Mapping_Kind_Axis) {
+        *out_pressed = ref_digital_pressed(elem, raw);
+        return true;
+    }
+    if(!ref_axis_mapped(elem)) {
+        *out_pressed = false;
+        return true;
+    }
+
+    int min, max;
+    ref_axis_range(elem, &min, &max);
+    const int value = raw->axes[elem.index];
+    const int threshold = min + (max - min) / 2;
+    if(abs(value - threshold) <= 2) return false;
+
+    *out_pressed = ref_in_range(value, min, max) && (max < min ? value <= threshold : value >= threshold);
+    return true;
+}
+
+// Returns false when SDL would keep the previous value, the input is outside of its range.
+static bool ref_axis(const Gpad_Mapping* mapping, const int axis, const Gpad_Raw_State* raw, float* out_value) {
+    const bool trigger = axis == Gpad_Axis_Left_Trigger || axis == Gpad_Axis_Right_Trigger;
+    // SDL has Y pointing down.
+    const float sign = axis == Gpad_Axis_Left_Y || axis == Gpad_Axis_Right_Y ? -1.0f : 1.0f;
+
+    if(mapping->half_axes & (1 << axis)) {
+        const Gpad_Mapping_Elem halves[2] = {mapping->axes[axis], mapping->negative_axes[axis]};
+        float result = 0.0f;
+        for(int half = 0; half < 2; half++) {
+            const Gpad_Mapping_Elem elem = halves[half];
+            const float half_sign = half == 0 ? sign : -sign;
+            if(elem.kind != Gpad_Mapping_Kind_Axis) {
+                result += ref_digital_pressed(elem, raw) ? half_sign : 0.0f;
+            } else if(ref_axis_mapped(elem)) {
+                int value = 0;
+                if(ref_axis_value(elem, raw, 0, half == 0 ? 32767 : -32768, &value)) {
+                    result += sign * (float)value / 32767.5f;
+                }
+            }
+        }
+        *out_value = result;
+        return true;
+    }
+
+    const Gpad_Mapping_Elem elem = mapping->axes[axis];
+    if(elem.kind != Gpad_Mapping_Kind_Axis) {
+        *out_value = ref_digital_pressed(elem, raw) ? GPAD_AXIS_MAX : GPAD_AXIS_MIN;
+        return true;
+    }
+    if(!ref_axis_mapped(elem)) {
+        *out_value = GPAD_AXIS_MIN;
+        return true;
+    }
+
+    int value = 0;
+    if(!ref_axis_value(elem, raw, trigger ? 0 : -32768, 32767, &value)) return false;
+    *out_value = trigger ? (float)value / 32767.0f * 2.0f - 1.0f : sign * ((float)value + 0.5f) / 32767.5f;
+    return true;
+}
+
+//
+// Tests
+//
+
+static void test_calibration(Gpad_Axis_Calibration* out_calibration) {
+    for(int i = 0; i < GPAD__MAX_RAW_AXES; i++) {
+        out_calibration[i].scale = TEST_AXIS_SCALE;
+        out_calibration[i].bias = TEST_AXIS_BIAS;
+    }
+}
+
+static void test_database(void) {
+    Gpad_Axis_Calibration calibration[GPAD__MAX_RAW_AXES];
+    test_calibration(calibration);
+
+    const int num_mappings = gpad__mapping_count();
+    for(int index = 0; index < num_mappings; index++) {
+        const Gpad_Mapping mapping = *gpad__get_mapping((Gpad_Mapping_Index)index);
+        const char* name = gpad__mapping_name((Gpad_Mapping_Index)index);
+
+        Gpad_Compiled_Mapping compiled;
+        gpad__compile_mapping(&mapping, calibration, &compiled);
+
+        for(int test_case = 0; test_case < TEST_CASES_PER_MAPPING; test_case++) {
+            Gpad_Raw_State raw;
+            test_raw_state(test_case, &raw);
+
+            Gpad_Device_State state;
+            gpad__evaluate_mapping(&compiled, &raw, &state);
+
+            for(int button = 0; button < Gpad_Button_COUNT; button++) {
+                bool pressed;
+                if(!ref_button(mapping.buttons[button], &raw, &pressed)) continue;
+                const bool ok = ((state.buttons >> button) & 1) == pressed;
+                test_check(ok, name, "button", gpad_button_name(button), test_case);
+            }
+
+            for(int axis = 0; axis < Gpad_Axis_COUNT; axis++) {
+                float value;
+                if(!ref_axis(&mapping, axis, &raw, &value)) continue;
+                const bool ok = fabsf(state.axes[axis] - value) <= TEST_AXIS_EPSILON;
+                test_check(ok, name, "axis", gpad_axis_name(axis), test_case);
+            }
+        }
+    }
+}
+
+// gpad__evaluate_mappings has to match gpad__evaluate_mapping exactly, including unused IDs in between and devices
+// which didn't change.
+static void test_batch(void) {
+    Gpad_Axis_Calibration calibration[GPAD__MAX_RAW_AXES];
+    test_calibration(calibration);
+
+    static Gpad_Compiled_Mapping mappings[GPAD_MAX_DEVICES];
+    static Gpad_Raw_State raws[GPAD_MAX_DEVICES];
+    static Gpad_Device_State states[GPAD_MAX_DEVICES];
+    static Gpad_Axis_Batch batch;
+    const Gpad_Compiled_Mapping* compiled[GPAD_MAX_DEVICES];
+    const Gpad_Raw_State* raw[GPAD_MAX_DEVICES];
+    Gpad_Device_State* out_states[GPAD_MAX_DEVICES];
+
+    const int num_mappings = gpad__mapping_count();
+    for(int first = 0; first < num_mappings; first += GPAD_MAX_DEVICES - 1) {
+        for(int device = 0; device < GPAD_MAX_DEVICES; device++) {
+            // Every third ID is unused.
+            const int index = first + device;
+            compiled[device] = NULL;
+            if(index < num_mappings && device % 3 != 2) {
+                gpad__compile_mapping(gpad__get_mapping((Gpad_Mapping_Index)index), calibration, &mappings[device]);
+                compiled[device] = &mappings[device];
+            }
+            test_raw_state(index, &raws[device]);
+            raw[device] = &raws[device];
+            out_states[device] = &states[device];
+        }
+
+        gpad__build_axis_batch(&batch, compiled, GPAD_MAX_DEVICES);
+
+        // Once for all devices, then only for every other one. The others have to keep their state.
+        for(int pass = 0; pass < 2; pass++) {
+            bool changed[GPAD_MAX_DEVICES];
+            for(int device = 0; device < GPAD_MAX_DEVICES; device++) {
+                changed[device] = pass == 0 || (first + device) % 2 == 0;
+                states[device].buttons = 0xffff;
+                for(int axis = 0; axis < Gpad_Axis_COUNT; axis++) {
+                    states[device].axes[axis] = 42.0f;
+                }
+            }
+            gpad__evaluate_mappings(&batch, compiled, raw, out_states, pass == 0 ? NULL : changed, GPAD_MAX_DEVICES);
+
+            for(int device = 0; device < GPAD_MAX_DEVICES; device++) {
+                if(!compiled[device]) continue;
+                Gpad_Device_State state;
+                if(changed[device]) {
+                    gpad__evaluate_mapping(compiled[device], raw[device], &state);
+                } else {
+                    state.buttons = 0xffff;
+                    for(int axis = 0; axis < Gpad_Axis_COUNT; axis++) {
+                        state.axes[axis] = 42.0f;
+                    }
+                }
+
+                const char* name = gpad__mapping_name((Gpad_Mapping_Index)(first + device));
+                test_check(state.buttons == states[device].buttons, name, "batch", "buttons", first + device);
+                for(int axis = 0; axis < Gpad_Axis_COUNT; axis++) {
+                    const bool ok = state.axes[axis] == states[device].axes[axis];
+                    test_check(ok, name, "batch", gpad_axis_name(axis), first + device);
+                }
+            }
+        }
+    }
+}
+
+static Gpad_Guid test_guid(const char* hex) {
+    Gpad_Guid guid;
+    for(int i = 0; i < 16; i++) {
+        unsigned int byte = 0;
+        sscanf(&hex[i * 2], "%2x", &byte);
+        guid.data[i] = (uint8_t)byte;
+    }
+    return guid;
+}
+
+// Device GUID and the database row gpad__resolve_mapping has to pick for it.
+static const char* g_test_resolve[][2] = {
+    {"03000000503200000210000011010000", "03000000503200000210000011010000"},
+    // Name CRC, the row with the same version wins over the one without a version.
+    {"0300abcd503200000210000011010000", "03000000503200000210000011010000"},
+    {"0300abcd5e0400008e02000073050000", "030000005e0400008e02000073050000"},
+    // Version only.
+    {"03000000503200000210000099990000", "03000000503200000210000000000000"},
+    // Both.
+    {"0300abcd503200000210000099990000", "03000000503200000210000000000000"},
+};
+
+static void test_resolve(void) {
+    const int num_tests = (int)(sizeof(g_test_resolve) / sizeof(g_test_resolve[0]));
+    for(int i = 0; i < num_tests; i++) {
+        const Gpad_Guid device = test_guid(g_test_resolve[i][0]);
+        const Gpad_Guid row = test_guid(g_test_resolve[i][1]);
+        const int want = gpad__find_mapping(&row);
+        test_check(want >= 0 && gpad__resolve_mapping(&device) == want, g_test_resolve[i][0], "resolve", "", i);
+    }
+}
+
+#define TEST_DATABASE_FILE "gpad_gamecontrollerdb_linux.bin"
+
+// Writes the data to a temporary file and loads it as the database.
+static bool test_load_database(const uint8_t* data, const size_t size) {
+    char path[] = "/tmp/gpad_test_XXXXXX";
+    const int fd = mkstemp(path);
+    if(fd < 0) return false;
+    const bool written = size == 0 || write(fd, data, size) == (ssize_t)size;
+    close(fd);
+    const bool loaded = written && gpad_load_database_file(path);
+    unlink(path);
+    return loaded;
+}
+
+typedef uint8_t Test_Damage;
+
+typedef enum Test_Damage_ {
+    Test_Damage_None,
+    Test_Damage_Empty,
+    Test_Damage_Short_Header,
+    Test_Damage_Header_Only,
+    Test_Damage_Half,
+    Test_Damage_Last_Byte_Missing,
+    Test_Damage_Magic,
+    Test_Damage_Version,
+    Test_Damage_Size,
+    Test_Damage_Platform,
+    Test_Damage_Checksum,
+    Test_Damage_Payload,
+    Test_Damage_COUNT,
+} Test_Damage_;
+
+static const char* g_test_damage_names[Test_Damage_COUNT] = {
+    "none", "empty", "short header", "header only", "half", "last byte missing",
+    "magic", "version", "size", "platform", "checksum", "payload",
+};
+
+// Returns NULL if the file build_db wrote next to the built-in database can't be read.
+static uint8_t* test_read_database_file(size_t* out_size) {
+    FILE* file = fopen(TEST_DATABASE_FILE, "rb");
+    if(!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    const size_t size = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* data = (uint8_t*)malloc(size);
+    const bool read = data && size > sizeof(Gpad_Database_Header) && fread(data, 1, size, file) == size;
+    fclose(file);
+    test_check(read, TEST_DATABASE_FILE, "read", "", 0);
+    if(!read) {
+        free(data);
+        return NULL;
+    }
+    *out_size = size;
+    return data;
+}
+
+// Every built-in mapping has to match the uncompressed pool of the database file. With build_db --compress they are
+// decoded into a cache of GPAD_MAX_DECODED_MAPPINGS entries, the walks forward, backward, in strides and back and
+// forth to a hot mapping evict every entry several times.
+static void test_database_pool(void) {
+    size_t size = 0;
+    uint8_t* data = test_read_database_file(&size);
+    if(!data) return;
+
+    const Gpad_Database_Header* header = (const Gpad_Database_Header*)data;
+    const Gpad_Mapping_Row* rows = (const Gpad_Mapping_Row*)(data + header->rows_offset);
+    const Gpad_Mapping* pool = (const Gpad_Mapping*)(data + header->pool_offset);
+    const int num_rows = (int)header->num_rows;
+    test_check(gpad__mapping_count() == num_rows, TEST_DATABASE_FILE, "rows", "", 0);
+    if(gpad__mapping_count() != num_rows) {
+        free(data);
+        return;
+    }
+
+    const char* walks[] = {"forward", "backward", "stride", "hot"};
+    for(int walk = 0; walk < 4; walk++) {
+        for(int i = 0; i < num_rows * (walk == 3 ? 2 : 1); i++) {
+            int index = i;
+            if(walk == 1) index = num_rows - 1 - i;
+            if(walk == 2) index = (int)((i * 37ll) % num_rows);
+            if(walk == 3) index = i % 2 ? i / 2 : 0;
+
+            const Gpad_Mapping* mapping = gpad__get_mapping((Gpad_Mapping_Index)index);
+            const bool ok = memcmp(mapping, &pool[rows[index].pool_index], sizeof(Gpad_Mapping)) == 0;
+            test_check(ok, gpad__mapping_name((Gpad_Mapping_Index)index), "pool", walks[walk], index);
+        }
+    }
+
+    free(data);
+}
+
+// The database file has the same mappings as the built-in database, so it can replace it.
+// Damaged copies have to be rejected and leave it in place.
+static void test_database_file(void) {
+    size_t size = 0;
+    uint8_t* data = test_read_database_file(&size);
+    uint8_t* copy = data ? (uint8_t*)malloc(size) : NULL;
+    if(!copy) {
+        free(data);
+        return;
+    }
+
+    // Pseudo GUIDs like "xinput" aren't in the hash index, so they aren't found in either database.
+    const Gpad_Database_Header* file_header = (const Gpad_Database_Header*)data;
+    const Gpad_Guid* guids = (const Gpad_Guid*)(data + file_header->guids_offset);
+    const int num_rows = (int)file_header->num_rows;
+    int num_found = 0;
+    for(int row = 0; row < num_rows; row++) {
+        num_found += gpad__find_mapping(&guids[row]) == row;
+    }
+
+    for(int damage = 0; damage < Test_Damage_COUNT; damage++) {
+        memcpy(copy, data, size);
+        Gpad_Database_Header* header = (Gpad_Database_Header*)copy;
+        size_t copy_size = size;
+        switch(damage) {
+            case Test_Damage_Empty: copy_size = 0; break;
+            case Test_Damage_Short_Header: copy_size = sizeof(Gpad_Database_Header) - 1; break;
+            case Test_Damage_Header_Only: copy_size = sizeof(Gpad_Database_Header); break;
+            case Test_Damage_Half: copy_size = size / 2; break;
+            case Test_Damage_Last_Byte_Missing: copy_size = size - 1; break;
+            case Test_Damage_Magic: header->magic[0] = 'X'; break;
+            case Test_Damage_Version: header->version++; break;
+            case Test_Damage_Size: header->size += 8; break;
+            case Test_Damage_Platform: snprintf(header->platform, sizeof(header->platform), "Windows"); break;
+            case Test_Damage_Checksum: header->checksum ^= 1; break;
+            case Test_Damage_Payload: copy[size - 1] ^= 1; break;
+        }
+
+        const char* damage_name = g_test_damage_names[damage];
+        const bool loaded = test_load_database(copy, copy_size);
+        test_check(loaded == (damage == Test_Damage_None), TEST_DATABASE_FILE, "load", damage_name, damage);
+
+        // Whichever of the two is in use, the rows are found at the same indices.
+        int found_after = 0;
+        for(int row = 0; row < num_rows; row++) {
+            found_after += gpad__find_mapping(&guids[row]) == row;
+        }
+        const bool found = gpad__mapping_count() == num_rows && found_after == num_found && num_found > 0;
+        test_check(found, TEST_DATABASE_FILE, "lookup after", damage_name, damage);
+    }
+
+    const bool missing_loaded = gpad_load_database_file("/nonexistent/" TEST_DATABASE_FILE);
+    test_check(!missing_loaded, TEST_DATABASE_FILE, "load", "missing", 0);
+
+    free(data);
+    free(copy);
+}
+
+static const char g_test_mapping_lines[] =
+    "# Comment\n"
+    "not a mapping\n"
+    "0300000050320000021000001101zz00,Bad hex,a:b0,platform:Linux\n"
+    "030000005032000002100000110100,Short GUID,a:b0,platform:Linux\n"
+    "03000000ffff00000100000000000000,No fields\n"
+    "03000000ffff00000200000000000000,Other platform,a:b0,platform:Windows\n"
+    "03000000ffff00000300000000000000,Good one,a:b1,platform:Linux\n"
+    "\n"
+    "03000000ffff00000400000000000000,Good two,a:b2,\r\n";
+
+// Whether the mapping found for the GUID maps A to the raw button.
+static bool test_maps_a_to(const char* guid_hex, const int button) {
+    const Gpad_Guid guid = test_guid(guid_hex);
+    const int index = gpad__find_mapping(&guid);
+    if(index < 0) return false;
+    const Gpad_Mapping_Elem elem = gpad__get_mapping((Gpad_Mapping_Index)index)->buttons[Gpad_Button_A];
+    return elem.kind == Gpad_Mapping_Kind_Button && elem.index == button;
+}
+
+// Runtime mappings override the database for their GUID, and broken lines are skipped without stopping the load.
+// Rebinding connected devices is covered by gpad_device_test.
+static void test_runtime_mappings(void) {
+    const char* name = "runtime mappings";
+    const int num_database = gpad__mapping_count();
+
+    const char* db_hex = "03000000503200000210000011010000";
+    const Gpad_Guid db_guid = test_guid(db_hex);
+    const int db_index = gpad__find_mapping(&db_guid);
+    test_check(db_index >= 0 && db_index < num_database, name, "database", db_hex, 0);
+
+    test_check(gpad_add_mapping("03000000503200000210000011010000,Override,a:b5,platform:Linux"), name, "add", "", 0);
+    const int index = gpad__find_mapping(&db_guid);
+    test_check(index >= num_database && test_maps_a_to(db_hex, 5), name, "override", db_hex, 0);
+    test_check(strcmp(gpad__mapping_name((Gpad_Mapping_Index)index), "Override") == 0, name, "override", "name", 0);
+    // The fallbacks find it too, before the database row.
+    const Gpad_Guid crc_guid = test_guid("0300abcd503200000210000011010000");
+    test_check(gpad__resolve_mapping(&crc_guid) == index, name, "override", "resolve", 0);
+
+    // Replaced in place.
+    test_check(gpad_add_mapping("03000000503200000210000011010000,Override,a:b6"), name, "add", "again", 0);
+    test_check(gpad__find_mapping(&db_guid) == index && test_maps_a_to(db_hex, 6), name, "override", "again", 0);
+    test_check(gpad__mapping_count() == num_database + 1, name, "override", "count", 0);
+
+    test_check(!gpad_add_mapping("not a mapping"), name, "add", "malformed", 0);
+    const bool other_added = gpad_add_mapping("03000000ffff00000200000000000000,Other,a:b0,platform:Windows");
+    test_check(!other_added, name, "add", "other platform", 0);
+
+    // Same lines from memory and from a file, only the two good ones count.
+    for(int pass = 0; pass < 2; pass++) {
+        const char* source = pass ? "file" : "memory";
+        const size_t size = sizeof(g_test_mapping_lines) - 1;
+        int count = -1;
+        if(pass == 0) {
+            count = gpad_load_mappings_from_memory(g_test_mapping_lines, size);
+        } else {
+            char path[] = "/tmp/gpad_test_XXXXXX";
+            const int fd = mkstemp(path);
+            if(fd >= 0 && write(fd, g_test_mapping_lines, size) == (ssize_t)size) {
+                count = gpad_load_mappings_from_file(path);
+            }
+            if(fd >= 0) {
+                close(fd);
+                unlink(path);
+            }
+        }
+        test_check(count == 2, name, "load count", source, pass);
+        test_check(test_maps_a_to("03000000ffff00000300000000000000", 1), name, "load good one", source, pass);
+        test_check(test_maps_a_to("03000000ffff00000400000000000000", 2), name, "load good two", source, pass);
+        const Gpad_Guid skipped[] = {
+            test_guid("03000000ffff00000100000000000000"),
+            test_guid("03000000ffff00000200000000000000"),
+        };
+        const bool none = gpad__find_mapping(&skipped[0]) < 0 && gpad__find_mapping(&skipped[1]) < 0;
+        test_check(none, name, "load skipped", source, pass);
+        test_check(gpad__mapping_count() == num_database + 3, name, "load", "count", pass);
+    }
+    test_check(gpad_load_mappings_from_file("/nonexistent/gamecontrollerdb.txt") == -1, name, "load", "missing", 0);
+}
+
+typedef struct Test_Mapping {
+    const char* fields;
+    uint64_t buttons;
+    uint8_t hat;
+    int axis; // Raw axis set to axis_value
+    int32_t axis_value;
+    uint16_t want_buttons;
+    int want_axis;
+    float want_value;
+} Test_Mapping;
+
+#define TEST_DPAD "dpup:h0.1,dpright:h0.2,dpdown:h0.4,dpleft:h0.8"
+
+static const Test_Mapping g_test_mappings[] = {
+    {"a:b0,b:b1", 1, 0, 0, 0, 1 << Gpad_Button_A, Gpad_Axis_Left_X, GPAD_AXIS_MIN},
+    {TEST_DPAD, 0, 3, 0, 0, 1 << Gpad_Button_Dpad_Up | 1 << Gpad_Button_Dpad_Right, Gpad_Axis_Left_X, GPAD_AXIS_MIN},
+    {TEST_DPAD, 0, 12, 0, 0, 1 << Gpad_Button_Dpad_Down | 1 << Gpad_Button_Dpad_Left, Gpad_Axis_Left_X, GPAD_AXIS_MIN},
+    {"leftx:a0", 0, 0, 0, 32767, 0, Gpad_Axis_Left_X, 1.0f},
+    {"leftx:a0", 0, 0, 0, -32768, 0, Gpad_Axis_Left_X, -1.0f},
+    {"leftx:a0~", 0, 0, 0, 32767, 0, Gpad_Axis_Left_X, -1.0f},
+    {"lefty:a1", 0, 0, 1, 32767, 0, Gpad_Axis_Left_Y, -1.0f},
+    {"lefttrigger:a2", 0, 0, 2, -32768, 0, Gpad_Axis_Left_Trigger, -1.0f},
+    {"lefttrigger:a2", 0, 0, 2, 32767, 0, Gpad_Axis_Left_Trigger, 1.0f},
+    {"lefttrigger:+a2", 0, 0, 2, 0, 0, Gpad_Axis_Left_Trigger, -1.0f},
+    {"lefttrigger:+a2", 0, 0, 2, 32767, 0, Gpad_Axis_Left_Trigger, 1.0f},
+    {"righttrigger:b7", 1 << 7, 0, 0, 0, 0, Gpad_Axis_Right_Trigger, 1.0f},
+    {"righttrigger:b7", 0, 0, 0, 0, 0, Gpad_Axis_Right_Trigger, -1.0f},
+    {"-leftx:h0.8,+leftx:h0.2", 0, 8, 0, 0, 0, Gpad_Axis_Left_X, -1.0f},
+    {"-leftx:h0.8,+leftx:h0.2", 0, 2, 0, 0, 0, Gpad_Axis_Left_X, 1.0f},
+    {"-leftx:h0.8,+leftx:h0.2", 0, 0, 0, 0, 0, Gpad_Axis_Left_X, 0.0f},
+    {"-lefty:b0,+lefty:b1", 1, 0, 0, 0, 0, Gpad_Axis_Left_Y, 1.0f},
+    {"-leftx:+a2,+leftx:b1", 2, 0, 2, 32767, 0, Gpad_Axis_Left_X, 0.0f},
+    {"-leftx:+a2,+leftx:b1", 0, 0, 2, 32767, 0, Gpad_Axis_Left_X, -1.0f},
+    {"-leftx:+a2,+leftx:b1", 0, 0, 2, 0, 0, Gpad_Axis_Left_X, 0.0f},
+    {"b:-a1,y:+a1", 0, 0, 1, -32768, 1 << Gpad_Button_B, Gpad_Axis_Left_X, GPAD_AXIS_MIN},
+    {"b:-a1,y:+a1", 0, 0, 1, 32767, 1 << Gpad_Button_Y, Gpad_Axis_Left_X, GPAD_AXIS_MIN},
+    {"b:-a1,y:+a1", 0, 0, 1, 0, 0, Gpad_Axis_Left_X, GPAD_AXIS_MIN},
+};
+
+static void test_mappings(void) {
+    Gpad_Axis_Calibration calibration[GPAD__MAX_RAW_AXES];
+    test_calibration(calibration);
+
+    const int num_tests = (int)(sizeof(g_test_mappings) / sizeof(g_test_mappings[0]));
+    for(int i = 0; i < num_tests; i++) {
+        const Test_Mapping* test = &g_test_mappings[i];
+
+        char line[256];
+        snprintf(line, sizeof(line), "ffffffff0000000000000000000000%02x,Test %i,%s,", i, i, test->fields);
+        Gpad_Guid guid = {0};
+        memset(guid.data, 0xff, 4);
+        guid.data[15] = (uint8_t)i;
+
+        const int index = gpad_add_mapping(line) ? gpad__find_mapping(&guid) : -1;
+        test_check(index >= 0, test->fields, "add", "mapping", i);
+        if(index < 0) continue;
+
+        Gpad_Compiled_Mapping compiled;
+        gpad__compile_mapping(gpad__get_mapping((Gpad_Mapping_Index)index), calibration, &compiled);
+
+        Gpad_Raw_State raw = {0};
+        raw.buttons = test->buttons;
+        raw.hats[0] = test->hat;
+        raw.axes[test->axis] = test->axis_value;
+
+        // Once alone and once as the only device of a batch.
+        Gpad_Device_State states[2];
+        gpad__evaluate_mapping(&compiled, &raw, &states[0]);
+
+        static Gpad_Axis_Batch batch;
+        const Gpad_Compiled_Mapping* batch_compiled = &compiled;
+        const Gpad_Raw_State* batch_raw = &raw;
+        Gpad_Device_State* batch_state = &states[1];
+        gpad__build_axis_batch(&batch, &batch_compiled, 1);
+        gpad__evaluate_mappings(&batch, &batch_compiled, &batch_raw, &batch_state, NULL, 1);
+
+        for(int j = 0; j < 2; j++) {
+            const float value = states[j].axes[test->want_axis];
+            test_check(states[j].buttons == test->want_buttons, test->fields, "buttons", "", i);
+            const char* axis_name = gpad_axis_name(test->want_axis);
+            test_check(fabsf(value - test->want_value) <= 1e-4f, test->fields, "axis", axis_name, i);
+        }
+    }
+}
+
+int main(void) {
+    test_database();
+    test_batch();
+    test_resolve();
+    test_database_pool();
+    // Replaces the built-in database with the file, which has the same mappings.
+    test_database_file();
+    // Add runtime mappings, so after the database tests.
+    test_runtime_mappings();
+    test_mappings();
+
+    printf("%i checks, %i failed\n", g_test_checks, g_test_failures);
+    return g_test_failures ? 1 : 0;
+}